@@ -0,0 +1,87 @@
+#ifndef QC_BENCH_H_
+#define QC_BENCH_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// Handed to every benchmark body, which must repeat the measured operation
+// iterations() times. Counters are reported per operation.
+class Run {
+public:
+  explicit Run(uint64_t iterations) : iterations_{iterations} {}
+
+  uint64_t iterations() const { return iterations_; }
+  void add_counter(std::string name, double total) {
+    counters_.emplace_back(std::move(name), total);
+  }
+  const std::vector<std::pair<std::string, double>> &counters() const {
+    return counters_;
+  }
+
+private:
+  uint64_t iterations_;
+  std::vector<std::pair<std::string, double>> counters_;
+};
+
+using body_t = std::function<void(Run &)>;
+
+struct Benchmark {
+  std::string name;
+  body_t body;
+};
+
+inline std::vector<Benchmark> &registry() {
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+struct Register {
+  Register(std::string name, body_t body) {
+    registry().push_back({std::move(name), std::move(body)});
+  }
+};
+
+// Prevents the optimizer from discarding a computed value.
+template <class T> void keep(T &&value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct Result {
+  std::string name;
+  uint64_t iterations;
+  double ns_per_op;
+  std::vector<std::pair<std::string, double>> counters;
+};
+
+// Doubles the iteration count until a run lasts at least min_time.
+inline Result measure(const Benchmark &benchmark,
+                      std::chrono::nanoseconds min_time) {
+  uint64_t iterations = 1;
+  while (true) {
+    Run run{iterations};
+    auto start = std::chrono::steady_clock::now();
+    benchmark.body(run);
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+    if (elapsed >= min_time || iterations >= (uint64_t{1} << 40)) {
+      Result result{benchmark.name, iterations,
+                    double(elapsed.count()) / iterations, {}};
+      for (const auto &[name, total] : run.counters()) {
+        result.counters.emplace_back(name, total / iterations);
+      }
+      return result;
+    }
+    uint64_t scale = elapsed.count() > 0 ? min_time / elapsed : 0;
+    iterations *= std::clamp<uint64_t>(scale + 1, 2, 100);
+  }
+}
+
+} // namespace bench
+
+#endif // QC_BENCH_H_
@@ -0,0 +1,73 @@
+#include "bench.h"
+#include "quikcli/flag.h"
+#include <random>
+#include <string_view>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <class Param> std::vector<std::string> make_inputs() {
+  std::mt19937_64 rng{42};
+  std::vector<std::string> inputs;
+  for (int i = 0; i < 1024; i++) {
+    if constexpr (std::same_as<Param, std::string>) {
+      inputs.emplace_back("artifact-" + std::to_string(rng() % 100000));
+    } else if constexpr (std::floating_point<Param>) {
+      inputs.emplace_back(std::to_string(
+          std::uniform_real_distribution<Param>{-1e6, 1e6}(rng)));
+    } else {
+      inputs.emplace_back(std::to_string(rng() % 1000000000));
+    }
+  }
+  return inputs;
+}
+
+template <class Param, bool stream> void convert(bench::Run &run) {
+  static const std::vector<std::string> inputs = make_inputs<Param>();
+  Param output{};
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    const std::string &input = inputs[i % inputs.size()];
+    if constexpr (stream) {
+      quikcli::stream_param(input, output);
+    } else {
+      quikcli::convert_param(input, output);
+    }
+    bench::keep(output);
+  }
+}
+
+// Builds a three parameter flag and sets it, as registering and parsing one
+// flag would; the converter is held inline rather than on the heap.
+void register_invoke(bench::Run &run) {
+  std::string_view inputs[] = {"640", "480", "2.5"};
+  int width = 0;
+  int height = 0;
+  double scale = 0;
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    quikcli::Flag flag{"size", "width, height and scale.", width, height,
+                       scale};
+    flag.set(inputs);
+    flag.parse();
+    bench::keep(width);
+  }
+}
+
+bench::Register flag_invoke{"flag/register_invoke", register_invoke};
+bench::Register int_stream{"process_params/int/stream", convert<int, true>};
+bench::Register int_convert{"process_params/int/from_chars",
+                            convert<int, false>};
+bench::Register u64_stream{"process_params/uint64_t/stream",
+                           convert<uint64_t, true>};
+bench::Register u64_convert{"process_params/uint64_t/from_chars",
+                            convert<uint64_t, false>};
+bench::Register double_stream{"process_params/double/stream",
+                              convert<double, true>};
+bench::Register double_convert{"process_params/double/from_chars",
+                               convert<double, false>};
+bench::Register string_stream{"process_params/string/stream",
+                              convert<std::string, true>};
+bench::Register string_convert{"process_params/string/assign",
+                               convert<std::string, false>};
+
+} // namespace
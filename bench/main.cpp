@@ -0,0 +1,86 @@
+#include "bench.h"
+#include "quikcli/quikcli.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void write_json(std::ostream &out, const std::vector<bench::Result> &results) {
+  out << "{\n  \"context\": {\"version\": \"" << QUIKCLI_VERSION
+      << "\", \"compiler\": \"" << __VERSION__ << "\"},\n"
+      << "  \"benchmarks\": [";
+  for (std::size_t i = 0; i < results.size(); i++) {
+    const bench::Result &result = results[i];
+    out << (i ? ",\n" : "\n") << "    {\"name\": \"" << result.name
+        << "\", \"iterations\": " << result.iterations
+        << ", \"ns_per_op\": " << result.ns_per_op;
+    for (const auto &[name, value] : result.counters) {
+      out << ", \"" << name << "\": " << value;
+    }
+    out << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+void write_table(std::ostream &out, const std::vector<bench::Result> &results) {
+  char line[256];
+  for (const bench::Result &result : results) {
+    std::snprintf(line, sizeof(line), "%-36s %14.1f ns/op",
+                  result.name.c_str(), result.ns_per_op);
+    out << line;
+    for (const auto &[name, value] : result.counters) {
+      std::snprintf(line, sizeof(line), "  %s=%.1f", name.c_str(), value);
+      out << line;
+    }
+    out << std::endl;
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string filter;
+  std::string output;
+  double min_time = 0.2;
+  quikcli::QuikCli cli{"quikcli_bench", QUIKCLI_VERSION};
+  cli.add_flag("filter", "only run benchmarks whose name contains this.",
+               filter)
+      .set_alias('f');
+  cli.add_flag("output", "write results as json to this file.", output)
+      .set_alias('o');
+  cli.add_flag("min-time", "minimum seconds spent in each benchmark.",
+               min_time)
+      .set_alias('t');
+  quikcli::Flag &json =
+      cli.add_flag("json", "print results as json instead of a table.")
+          .set_alias('j');
+  if (quikcli::ParseResult<> result = cli.try_parse_flags(argc, argv);
+      !result) {
+    std::cerr << result.error().exception().what() << std::endl;
+    return 1;
+  }
+  if (!cli.is_active()) {
+    return 0;
+  }
+
+  std::vector<bench::Result> results;
+  for (const bench::Benchmark &benchmark : bench::registry()) {
+    if (benchmark.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    results.push_back(bench::measure(
+        benchmark, std::chrono::nanoseconds{int64_t(min_time * 1e9)}));
+    if (!json.is_set()) {
+      write_table(std::cout, {results.back()});
+    }
+  }
+  if (json.is_set()) {
+    write_json(std::cout, results);
+  }
+  if (!output.empty()) {
+    std::ofstream file{output};
+    write_json(file, results);
+  }
+}
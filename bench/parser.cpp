@@ -0,0 +1,158 @@
+#include "bench.h"
+#include "quikcli/quikcli.h"
+#include <chrono>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr quikcli::FlagSchema schema{{
+    {"files", "input files.", 'f', quikcli::FlagParamSize::VARIADIC},
+    {"output", "output file.", 'o', 1},
+    {"verbose", "verbose output.", 'v'},
+    {"threads", "worker threads.", 'j', 1},
+}};
+
+// argv of the form: prog -v --output out.txt -j 8 --files file-0 ... file-n
+std::vector<char *> make_argv(std::size_t files,
+                              std::vector<std::string> &storage) {
+  storage = {"prog", "-v", "--output", "out.txt", "-j", "8", "--files"};
+  for (std::size_t i = 0; i < files; i++) {
+    storage.emplace_back("file-" + std::to_string(i));
+  }
+  std::vector<char *> argv;
+  for (std::string &arg : storage) {
+    argv.emplace_back(arg.data());
+  }
+  return argv;
+}
+
+template <std::size_t files> void parse_runtime(bench::Run &run) {
+  std::vector<std::string> storage;
+  std::vector<char *> argv = make_argv(files, storage);
+  std::size_t seen = 0;
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    quikcli::QuikCli cli{"prog", "0.0.1"};
+    std::string output;
+    int threads;
+    cli.add_flag("files", "input files.", [&](quikcli::flag_params_t params) {
+         seen += params.size();
+       }).set_alias('f');
+    cli.add_flag("output", "output file.", output).set_alias('o');
+    cli.add_flag("verbose", "verbose output.").set_alias('v');
+    cli.add_flag("threads", "worker threads.", threads).set_alias('j');
+    cli.parse_flags(argv.size(), argv.data());
+  }
+  bench::keep(seen);
+  run.add_counter("args", double(argv.size()) * run.iterations());
+}
+
+// A QuikCli backed by an arena; counts the allocations parse_flags makes.
+template <std::size_t files> void parse_arena(bench::Run &run) {
+  std::vector<std::string> storage;
+  std::vector<char *> argv = make_argv(files, storage);
+  std::size_t seen = 0;
+  uint64_t allocations = 0;
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    std::pmr::monotonic_buffer_resource arena{16384};
+    quikcli::CountingResource counter{&arena};
+    quikcli::QuikCli cli{"prog", "0.0.1", &counter};
+    std::string output;
+    int threads;
+    cli.add_flag("files", "input files.", [&](quikcli::flag_params_t params) {
+         seen += params.size();
+       }).set_alias('f');
+    cli.add_flag("output", "output file.", output).set_alias('o');
+    cli.add_flag("verbose", "verbose output.").set_alias('v');
+    cli.add_flag("threads", "worker threads.", threads).set_alias('j');
+    uint64_t before = counter.allocations();
+    cli.parse_flags(argv.size(), argv.data());
+    allocations += counter.allocations() - before;
+  }
+  bench::keep(seen);
+  run.add_counter("args", double(argv.size()) * run.iterations());
+  run.add_counter("allocations", allocations);
+}
+
+// One QuikCli checking the same command line repeatedly, as when vetting
+// stored command lines; nothing is set and no callbacks run.
+template <std::size_t files> void parse_validate(bench::Run &run) {
+  std::vector<std::string> storage;
+  std::vector<char *> argv = make_argv(files, storage);
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  std::string output;
+  int threads;
+  cli.add_flag("files", "input files.", [](quikcli::flag_params_t) {})
+      .set_alias('f');
+  cli.add_flag("output", "output file.", output).set_alias('o');
+  cli.add_flag("verbose", "verbose output.").set_alias('v');
+  cli.add_flag("threads", "worker threads.", threads).set_alias('j');
+  std::size_t valid = 0;
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    valid += cli.validate_flags(argv.size(), argv.data()).has_value();
+  }
+  bench::keep(valid);
+  run.add_counter("args", double(argv.size()) * run.iterations());
+}
+
+// Eight flags whose deferred callbacks each spin for about 50us, standing in
+// for loading an index or opening a data file; the last depends on the rest.
+template <std::size_t threads> void parse_deferred(bench::Run &run) {
+  std::vector<std::string> storage{"prog"};
+  for (int i = 0; i < 8; i++) {
+    storage.emplace_back("--load-" + std::to_string(i));
+  }
+  std::vector<char *> argv;
+  for (std::string &arg : storage) {
+    argv.emplace_back(arg.data());
+  }
+  auto load = [](quikcli::flag_params_t) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(50);
+    while (std::chrono::steady_clock::now() < end) {
+    }
+  };
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    quikcli::QuikCli cli{"prog", "0.0.1"};
+    cli.set_parse_threads(threads);
+    for (int j = 0; j < 8; j++) {
+      quikcli::Flag &flag =
+          cli.add_flag(storage[j + 1].substr(2), "loads something.", load);
+      for (int k = 0; j == 7 && k < 7; k++) {
+        flag.depends_on(storage[k + 1].substr(2));
+      }
+    }
+    cli.parse_flags(argv.size(), argv.data());
+  }
+  run.add_counter("flags", 8.0 * run.iterations());
+}
+
+template <std::size_t files> void parse_schema(bench::Run &run) {
+  std::vector<std::string> storage;
+  std::vector<char *> argv = make_argv(files, storage);
+  std::size_t seen = 0;
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    auto args = schema.parse(argv.size(), argv.data());
+    seen += args.params("files").size();
+  }
+  bench::keep(seen);
+  run.add_counter("args", double(argv.size()) * run.iterations());
+}
+
+bench::Register runtime_10{"parse_flags/runtime/10", parse_runtime<10>};
+bench::Register runtime_1k{"parse_flags/runtime/1000", parse_runtime<1000>};
+bench::Register runtime_100k{"parse_flags/runtime/100000",
+                             parse_runtime<100000>};
+bench::Register arena_10{"parse_flags/arena/10", parse_arena<10>};
+bench::Register arena_100k{"parse_flags/arena/100000", parse_arena<100000>};
+bench::Register validate_10{"parse_flags/validate/10", parse_validate<10>};
+bench::Register validate_100k{"parse_flags/validate/100000",
+                              parse_validate<100000>};
+bench::Register deferred_1{"parse_flags/deferred/1", parse_deferred<1>};
+bench::Register deferred_4{"parse_flags/deferred/4", parse_deferred<4>};
+bench::Register schema_10{"parse_flags/schema/10", parse_schema<10>};
+bench::Register schema_1k{"parse_flags/schema/1000", parse_schema<1000>};
+bench::Register schema_100k{"parse_flags/schema/100000",
+                            parse_schema<100000>};
+
+} // namespace
@@ -0,0 +1,53 @@
+#include "bench.h"
+#include "quikcli/quikcli.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+// option names of the form: src/module-17/component_4242.cpp
+std::vector<std::string> make_options(std::size_t count) {
+  std::vector<std::string> options;
+  options.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    options.emplace_back("src/module-" + std::to_string(i % 97) +
+                         "/component_" + std::to_string(i) + ".cpp");
+  }
+  return options;
+}
+
+template <std::size_t count> void fuzzy_score(bench::Run &run) {
+  std::vector<std::string> options = make_options(count);
+  quikcli::FuzzyMatcher matcher{"mod4comp"};
+  int64_t total = 0;
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    for (const std::string &option : options) {
+      total += matcher.score(option);
+    }
+  }
+  bench::keep(total);
+  run.add_counter("options", double(count) * run.iterations());
+}
+
+// types a query one character at a time, as the Select component does
+template <std::size_t count> void select_filter(bench::Run &run) {
+  quikcli::Select select{"> ", make_options(count), [](std::string) {}};
+  constexpr std::string_view query = "mod4comp";
+  std::size_t matched = 0;
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    for (std::size_t length = 0; length <= query.size(); length++) {
+      matched += select.filter(query.substr(0, length)).size();
+      select.sort(10);
+    }
+    matched += select.filter("").size();
+  }
+  bench::keep(matched);
+  run.add_counter("keystrokes", double(query.size()) * run.iterations());
+}
+
+bench::Register score_1k{"fuzzy/score/1000", fuzzy_score<1000>};
+bench::Register score_100k{"fuzzy/score/100000", fuzzy_score<100000>};
+bench::Register filter_1k{"select/filter/1000", select_filter<1000>};
+bench::Register filter_100k{"select/filter/100000", select_filter<100000>};
+
+} // namespace
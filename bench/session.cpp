@@ -0,0 +1,76 @@
+#include "bench.h"
+#include "quikcli/quikcli.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// A setup wizard: three prompts, two choices, a download and an install.
+void add_wizard(quikcli::QuikCli &cli, std::vector<std::string> &answers,
+                std::thread &worker) {
+  for (const char *prompt : {"host: ", "user: ", "directory: "}) {
+    cli.emplace_component<quikcli::TextInput>(
+        prompt, [&](std::string &value) { answers.push_back(value); });
+  }
+  std::vector<std::string> options;
+  for (int i = 0; i < 50; i++) {
+    options.push_back("option-" + std::to_string(i));
+  }
+  for (const char *prompt : {"region: ", "size: "}) {
+    cli.emplace_component<quikcli::Select>(
+        prompt, options,
+        [&](std::string &value) { answers.push_back(value); });
+  }
+  cli.emplace_component<quikcli::Loader>([&](quikcli::Loader &loader) {
+    worker = std::thread{[&loader] {
+      for (int i = 1; i <= 100; i++) {
+        loader.update(i / 100.0);
+      }
+    }};
+  });
+  cli.emplace_component<quikcli::ProgressBoard>(
+      std::vector<std::string>{"core", "plugins", "docs", "config"},
+      [&](quikcli::ProgressBoard &board) {
+        worker.join();
+        worker = std::thread{[&board] {
+          for (int i = 1; i <= 100; i++) {
+            for (std::size_t j = 0; j < board.size(); j++) {
+              board.handle(j).update(i / 100.0);
+            }
+          }
+        }};
+      });
+  cli.emplace_component<quikcli::Display>(
+      std::vector<std::string>{"installed."});
+}
+
+// The whole wizard replayed from a recorded session.
+void replay(bench::Run &run) {
+  const char *path = "/tmp/quikcli_bench.qcs";
+  {
+    quikcli::Session session{path, quikcli::Session::Mode::RECORD};
+    for (const char *value : {"example.com", "admin", "/opt/app"}) {
+      session.record("TextInput", value);
+    }
+    for (const char *value : {"option-12", "option-40"}) {
+      session.record("Select", value);
+    }
+    session.save();
+  }
+  std::vector<std::string> answers;
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    quikcli::QuikCli cli{"wizard", "0.0.1"};
+    cli.replay_session(path);
+    std::thread worker;
+    answers.clear();
+    add_wizard(cli, answers, worker);
+    cli.run();
+    worker.join();
+  }
+  bench::keep(answers);
+}
+
+bench::Register replay_wizard{"session/replay/wizard", replay};
+
+} // namespace
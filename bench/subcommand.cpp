@@ -0,0 +1,57 @@
+#include "bench.h"
+#include "quikcli/quikcli.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t commands = 80;
+constexpr std::size_t flags_per_command = 10;
+
+void add_command_flags(quikcli::QuikCli &cli, const std::string &prefix,
+                       std::vector<std::string> &values) {
+  for (std::size_t i = 0; i < flags_per_command; i++) {
+    cli.add_flag(prefix + "option-" + std::to_string(i), "an option.",
+                 values[i]);
+  }
+}
+
+// argv of the form: prog command-40 --option-3 value
+char *argv[] = {const_cast<char *>("prog"), const_cast<char *>("command-40"),
+                const_cast<char *>("--option-3"), const_cast<char *>("value")};
+char *eager_argv[] = {const_cast<char *>("prog"),
+                      const_cast<char *>("--command-40-option-3"),
+                      const_cast<char *>("value")};
+
+// every command's flags registered up front under prefixed names
+void startup_eager(bench::Run &run) {
+  std::vector<std::string> values(flags_per_command);
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    quikcli::QuikCli cli{"prog", "0.0.1"};
+    for (std::size_t c = 0; c < commands; c++) {
+      add_command_flags(cli, "command-" + std::to_string(c) + "-", values);
+    }
+    cli.parse_flags(3, eager_argv);
+  }
+  bench::keep(values);
+}
+
+void startup_lazy(bench::Run &run) {
+  std::vector<std::string> values(flags_per_command);
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    quikcli::QuikCli cli{"prog", "0.0.1"};
+    for (std::size_t c = 0; c < commands; c++) {
+      cli.add_subcommand("command-" + std::to_string(c), "a command.",
+                         [&](quikcli::QuikCli &command) {
+                           add_command_flags(command, "", values);
+                         });
+    }
+    cli.parse_flags(4, argv);
+  }
+  bench::keep(values);
+}
+
+bench::Register eager{"subcommand/startup/eager", startup_eager};
+bench::Register lazy{"subcommand/startup/lazy", startup_lazy};
+
+} // namespace
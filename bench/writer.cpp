@@ -0,0 +1,158 @@
+#include "bench.h"
+#include "quikcli/component.h"
+#include <atomic>
+#include <fcntl.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+int null_fd() {
+  static int fd = open("/dev/null", O_WRONLY);
+  return fd;
+}
+
+// /dev/null is not a terminal, so writers default to structured output
+quikcli::Writer &terminal(quikcli::Writer &writer) {
+  writer.set_structured(false);
+  return writer;
+}
+
+void report(bench::Run &run, const quikcli::Writer &writer) {
+  run.add_counter("bytes", writer.total_stats().bytes);
+  run.add_counter("syscalls", writer.total_stats().syscalls);
+}
+
+// A 40 line Display block written as a new frame every time.
+void out_full(bench::Run &run) {
+  quikcli::Writer writer{null_fd()};
+  terminal(writer);
+  std::vector<std::string> lines(40, std::string(120, '#'));
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    writer.out(lines);
+  }
+  report(run, writer);
+}
+
+// 40 progress bars redrawn in place, each advancing by one cell per frame.
+void out_redraw(bench::Run &run) {
+  quikcli::Writer writer{null_fd()};
+  terminal(writer);
+  std::vector<std::string> lines(40);
+  for (uint64_t i = 0; i < run.iterations(); i++) {
+    for (std::size_t j = 0; j < lines.size(); j++) {
+      quikcli::draw_bar(lines[j], 120, double((i + j) % 1000) / 1000);
+    }
+    writer.reset_cursor();
+    writer.out(lines);
+  }
+  report(run, writer);
+}
+
+// Loader fed by a worker thread at an uncapped frame rate; reports the cost
+// per update and how many of them turned into frames. Structured output only
+// reports steps of 5%, however many updates there are.
+template <bool structured> void loader_redraw(bench::Run &run) {
+  quikcli::Writer writer{null_fd()};
+  writer.set_structured(structured);
+  uint64_t steps = run.iterations();
+  std::thread worker;
+  quikcli::Loader loader{[&](quikcli::Loader &loader) {
+    worker = std::thread{[&loader, steps] {
+      for (uint64_t i = 1; i <= steps; i++) {
+        loader.update(double(i) / steps);
+      }
+    }};
+  }};
+  loader.set_max_frame_rate(0);
+  loader.run(writer);
+  worker.join();
+  report(run, writer);
+  run.add_counter("frames", writer.total_stats().frames);
+}
+
+// Four threads log while a 4 bar region is redrawn; each frame prints what
+// was logged since the last above the region.
+void log_above(bench::Run &run) {
+  quikcli::Writer writer{null_fd()};
+  terminal(writer);
+  std::vector<std::string> lines(4);
+  std::atomic<uint64_t> logged = 0;
+  uint64_t lines_per_thread = run.iterations() / 4 + 1;
+  std::vector<std::thread> loggers;
+  for (int t = 0; t < 4; t++) {
+    loggers.emplace_back([&writer, &logged, lines_per_thread] {
+      for (uint64_t i = 0; i < lines_per_thread; i++) {
+        writer.log("worker finished item " + std::to_string(i));
+        logged++;
+      }
+    });
+  }
+  for (uint64_t frame = 0; logged < 4 * lines_per_thread; frame++) {
+    for (std::size_t j = 0; j < lines.size(); j++) {
+      quikcli::draw_bar(lines[j], 120, double((frame + j) % 1000) / 1000);
+    }
+    writer.reset_cursor();
+    writer.out(lines);
+  }
+  for (std::thread &logger : loggers) {
+    logger.join();
+  }
+  writer.flush_logs();
+  report(run, writer);
+  run.add_counter("frames", writer.total_stats().frames);
+}
+
+// The redraw above into a pipe drained at about 512KB/s, like a terminal over a
+// slow link, until the last frame has been produced; reports the cost per
+// frame to the thread producing them.
+template <uint32_t frame_rate> void redraw_slow(bench::Run &run) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return;
+  }
+  std::atomic<bool> produced = false;
+  std::thread reader{[&produced, fd = fds[0]] {
+    char chunk[512];
+    while (read(fd, chunk, sizeof(chunk)) > 0) {
+      if (!produced) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+      }
+    }
+  }};
+  {
+    quikcli::Writer writer{fds[1]};
+    terminal(writer).set_render_rate(frame_rate);
+    std::vector<std::string> lines(40);
+    for (uint64_t i = 0; i < run.iterations(); i++) {
+      for (std::size_t j = 0; j < lines.size(); j++) {
+        quikcli::draw_bar(lines[j], 120, double((i + j) % 1000) / 1000);
+      }
+      writer.begin_frame();
+      writer.reset_cursor();
+      writer.out(lines);
+      writer.end_frame();
+    }
+    produced = true;
+    writer.sync();
+    report(run, writer);
+    run.add_counter("frames", writer.total_stats().frames);
+  }
+  close(fds[1]);
+  reader.join();
+  close(fds[0]);
+}
+
+bench::Register full{"writer/out/full_40x120", out_full};
+bench::Register redraw{"writer/out/redraw_40x120", out_redraw};
+bench::Register loader{"loader/redraw", loader_redraw<false>};
+bench::Register loader_structured{"loader/structured", loader_redraw<true>};
+bench::Register log_region{"writer/log_above_4x120", log_above};
+bench::Register slow_direct{"writer/slow_terminal/direct",
+                            redraw_slow<0>};
+bench::Register slow_thread{"writer/slow_terminal/render_thread_60hz",
+                            redraw_slow<60>};
+
+} // namespace
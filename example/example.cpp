@@ -1,6 +1,7 @@
 #include "quikcli/component.h"
 #include "quikcli/quikcli.h"
 #include <chrono>
+#include <fstream>
 #include <memory>
 #include <thread>
 
@@ -27,10 +28,61 @@ std::unique_ptr<quikcli::Component> make_init_loader() {
   });
 }
 
+std::unique_ptr<quikcli::Component> make_asset_board() {
+  std::vector<std::string> assets{"textures", "models", "sounds", "maps"};
+  return std::make_unique<quikcli::ProgressBoard>(
+      assets, [](quikcli::ProgressBoard &board) {
+        for (std::size_t i = 0; i < board.size(); i++) {
+          std::thread loading([handle = board.handle(i), i]() mutable {
+            for (int j = 1; j <= 100; j++) {
+              handle.update(0.01 * j);
+              std::this_thread::sleep_for(
+                  std::chrono::milliseconds(10 * (i + 1)));
+            }
+          });
+          loading.detach();
+        }
+      });
+}
+
+// Loads the roster in the background while the earlier screens are shown.
+class ClassRoster : public quikcli::AsyncComponent {
+public:
+  quikcli::Task prepare(quikcli::Scheduler &scheduler) override {
+    roster_ = co_await scheduler.offload([] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+      return std::vector<std::string>{"Available classes:", "  - Warrior",
+                                      "  - Mage", "  - Rogue"};
+    });
+  }
+  quikcli::Task render(quikcli::Writer &writer,
+                       quikcli::Scheduler &) override {
+    writer.out(roster_);
+    co_return;
+  }
+  const char *name() const override { return "ClassRoster"; }
+
+private:
+  std::vector<std::string> roster_;
+};
+
 int main(int argc, char *argv[]) {
   quikcli::QuikCli cli{"quikcli", "0.0.1"};
+  std::string trace_path;
+  cli.add_flag("trace", "write a chrome trace of the session to a file.",
+               trace_path)
+      .set_alias('t');
   cli.parse_flags(argc, argv);
+  if (!trace_path.empty()) {
+    cli.tracer().enable();
+  }
   cli.push_component(make_welcome_message());
   cli.push_component(make_init_loader());
+  cli.push_component(make_asset_board());
+  cli.push_component(std::make_unique<ClassRoster>());
   cli.run();
+  if (!trace_path.empty()) {
+    std::ofstream trace{trace_path};
+    cli.tracer().write_chrome_trace(trace);
+  }
 }
@@ -0,0 +1,342 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_ASYNC_H_
+#define QC_ASYNC_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "quikcli/component.h"
+#include "quikcli/exception.h"
+#include "quikcli/writer.h"
+
+namespace quikcli {
+
+class Scheduler;
+
+// A lazily started coroutine. Awaiting a task starts it if no one has yet and
+// resumes the awaiter once it finishes, rethrowing anything it threw.
+class Task {
+public:
+  struct promise_type {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+    bool started = false;
+
+    Task get_return_object() {
+      return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    auto final_suspend() noexcept {
+      struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+          std::coroutine_handle<> continuation = handle.promise().continuation;
+          return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+      };
+      return FinalAwaiter{};
+    }
+    void return_void() {}
+    void unhandled_exception() { exception = std::current_exception(); }
+  };
+
+  /* Constructors & Destructors - No Copy Default Move */
+  Task(Task &) = delete;
+  Task &operator=(Task &) = delete;
+  Task(Task &&other) noexcept : handle_{std::exchange(other.handle_, {})} {}
+  Task &operator=(Task &&other) noexcept {
+    std::swap(handle_, other.handle_);
+    return *this;
+  }
+
+  ~Task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+public:
+  bool done() const { return !handle_ || handle_.done(); }
+
+  /* Awaitable */
+  auto operator co_await() noexcept {
+    struct TaskAwaiter {
+      Task *task;
+
+      bool await_ready() const noexcept { return task->done(); }
+      std::coroutine_handle<>
+      await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        promise_type &promise = task->handle_.promise();
+        promise.continuation = awaiting;
+        if (promise.started) {
+          return std::noop_coroutine();
+        }
+        promise.started = true;
+        return task->handle_;
+      }
+      void await_resume() { task->rethrow(); }
+    };
+    return TaskAwaiter{this};
+  }
+
+private:
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle_{handle} {}
+
+  void rethrow() {
+    if (handle_ && handle_.promise().exception) {
+      std::rethrow_exception(std::exchange(handle_.promise().exception, {}));
+    }
+  }
+
+private:
+  std::coroutine_handle<promise_type> handle_;
+
+  friend class Scheduler;
+};
+
+// A single threaded event loop for Tasks. Work handed to offload() runs on its
+// own thread and resumes the awaiting task back on the loop thread, so tasks
+// never run concurrently with each other.
+class Scheduler {
+private:
+  using clock = std::chrono::steady_clock;
+
+  struct Timer {
+    clock::time_point deadline;
+    std::coroutine_handle<> handle;
+
+    bool operator>(const Timer &other) const {
+      return deadline > other.deadline;
+    }
+  };
+
+  template <class Result> struct Offloaded {
+    using value_t =
+        std::conditional_t<std::is_void_v<Result>, std::monostate, Result>;
+    std::optional<value_t> value;
+    std::exception_ptr exception;
+  };
+
+public:
+  /* Constructors & Destructors - No Copy No Move */
+  Scheduler() = default;
+
+  Scheduler(Scheduler &) = delete;
+  Scheduler &operator=(Scheduler &) = delete;
+  Scheduler(Scheduler &&) = delete;
+  Scheduler &operator=(Scheduler &&) = delete;
+
+  // Tasks still waiting on offloaded work are not resumed, but the work
+  // itself is allowed to finish.
+  ~Scheduler() {
+    std::unique_lock lock{mutex_};
+    wake_.wait(lock, [&] { return pending_ == 0; });
+  }
+
+public:
+  /* Runtime */
+  void spawn(Task &task) {
+    if (!task.done() && !task.handle_.promise().started) {
+      task.handle_.promise().started = true;
+      ready_.push_back(task.handle_);
+    }
+  }
+  void run_until(Task &task) {
+    spawn(task);
+    resume_ready();
+    while (!task.done()) {
+      collect(true);
+      resume_ready();
+    }
+    task.rethrow();
+  }
+  // Resumes whatever is ready without blocking.
+  void poll() {
+    resume_ready();
+    collect(false);
+    resume_ready();
+  }
+
+  /* Awaitables */
+  auto sleep_for(clock::duration duration) {
+    struct SleepAwaiter {
+      Scheduler *scheduler;
+      clock::time_point deadline;
+
+      bool await_ready() const { return deadline <= clock::now(); }
+      void await_suspend(std::coroutine_handle<> handle) {
+        scheduler->timers_.push({deadline, handle});
+      }
+      void await_resume() {}
+    };
+    return SleepAwaiter{this, clock::now() + duration};
+  }
+  template <class Fn> auto offload(Fn fn) {
+    using result_t = std::invoke_result_t<Fn>;
+    struct OffloadAwaiter {
+      Scheduler *scheduler;
+      Fn fn;
+      std::shared_ptr<Offloaded<result_t>> state =
+          std::make_shared<Offloaded<result_t>>();
+
+      bool await_ready() const { return false; }
+      void await_suspend(std::coroutine_handle<> handle) {
+        scheduler->begin_offload();
+        std::thread{[scheduler = scheduler, fn = std::move(fn), state = state,
+                     handle]() mutable {
+          try {
+            if constexpr (std::is_void_v<result_t>) {
+              fn();
+              state->value.emplace();
+            } else {
+              state->value.emplace(fn());
+            }
+          } catch (...) {
+            state->exception = std::current_exception();
+          }
+          scheduler->end_offload(handle);
+        }}.detach();
+      }
+      result_t await_resume() {
+        if (state->exception) {
+          std::rethrow_exception(state->exception);
+        }
+        if constexpr (!std::is_void_v<result_t>) {
+          return std::move(*state->value);
+        }
+      }
+    };
+    return OffloadAwaiter{this, std::move(fn)};
+  }
+
+private:
+  void resume_ready() {
+    while (!ready_.empty()) {
+      std::coroutine_handle<> handle = ready_.front();
+      ready_.pop_front();
+      handle.resume();
+    }
+  }
+  // Moves finished offloads and expired timers to the ready queue, waiting
+  // for the first of them if block is set.
+  void collect(bool block) {
+    std::unique_lock lock{mutex_};
+    if (block && completed_.empty()) {
+      if (timers_.empty() && pending_ == 0) {
+        throw Exception(ExceptionType::UNKNOWN,
+                        "task is suspended with nothing left to wait on.");
+      }
+      if (timers_.empty()) {
+        wake_.wait(lock, [&] { return !completed_.empty(); });
+      } else {
+        wake_.wait_until(lock, timers_.top().deadline,
+                         [&] { return !completed_.empty(); });
+      }
+    }
+    ready_.insert(ready_.end(), completed_.begin(), completed_.end());
+    completed_.clear();
+    lock.unlock();
+    while (!timers_.empty() && timers_.top().deadline <= clock::now()) {
+      ready_.push_back(timers_.top().handle);
+      timers_.pop();
+    }
+  }
+  void begin_offload() {
+    std::lock_guard lock{mutex_};
+    pending_++;
+  }
+  void end_offload(std::coroutine_handle<> handle) {
+    std::lock_guard lock{mutex_};
+    completed_.push_back(handle);
+    pending_--;
+    wake_.notify_all();
+  }
+
+private:
+  std::deque<std::coroutine_handle<>> ready_;
+  std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::vector<std::coroutine_handle<>> completed_;
+  uint32_t pending_ = 0;
+};
+
+// A component rendered by a coroutine. prepare() is started ahead of time by
+// QuikCli, while earlier components are still on screen, so it must not write
+// to the terminal; render() runs once the component's turn comes and
+// prepare() has finished.
+class AsyncComponent : public Component {
+public:
+  virtual Task prepare(Scheduler &) { co_return; }
+  virtual Task render(Writer &writer, Scheduler &scheduler) = 0;
+
+  void run(Writer &writer) override {
+    Scheduler scheduler;
+    run(writer, scheduler);
+  }
+  void run(Writer &writer, Scheduler &scheduler) {
+    prefetch(scheduler);
+    Task task = start(writer, scheduler);
+    scheduler.run_until(task);
+  }
+  void prefetch(Scheduler &scheduler) {
+    if (!prepared_.has_value()) {
+      prepared_.emplace(prepare(scheduler));
+      scheduler.spawn(*prepared_);
+    }
+  }
+
+private:
+  Task start(Writer &writer, Scheduler &scheduler) {
+    co_await *prepared_;
+    co_await render(writer, scheduler);
+  }
+
+private:
+  std::optional<Task> prepared_;
+};
+
+} // namespace quikcli
+
+#endif // QC_ASYNC_H_
@@ -0,0 +1,396 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_COMPLETION_H_
+#define QC_COMPLETION_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "quikcli/constants.h"
+
+namespace quikcli {
+
+// What a completion script knows about a program. The script is generated
+// once, so the shell completes from this table without running the program.
+struct CompletionTable {
+  struct Flag {
+    std::string name;
+    std::optional<char> alias;
+    std::string description;
+    uint32_t param_count;
+    // space separated values to offer for its parameters instead of files
+    std::string values = {};
+  };
+  // A subcommand, completed by the program's own script once it is named.
+  struct Command {
+    std::string name;
+    std::string description;
+    std::vector<Flag> flags = {};
+    std::vector<Command> commands = {};
+  };
+
+  std::string program;
+  std::vector<Flag> flags;
+  std::vector<Command> commands;
+};
+
+namespace completion {
+
+// Program names may contain characters that are not valid in function names.
+inline std::string function_name(std::string_view program) {
+  std::string name = "_";
+  for (char c : program) {
+    bool word = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                (c >= '0' && c <= '9');
+    name += word ? c : '_';
+  }
+  return name;
+}
+
+// Quotes str in single quotes, for both sh and fish.
+inline void write_quoted(std::ostream &out, std::string_view str,
+                         bool fish = false) {
+  out << '\'';
+  for (char c : str) {
+    if (c == '\'') {
+      out << (fish ? "\\'" : "'\\''");
+    } else if (fish && c == '\\') {
+      out << "\\\\";
+    } else {
+      out << c;
+    }
+  }
+  out << '\'';
+}
+
+// The flags and subcommands completed once the subcommands named in path have
+// been typed, e.g. "/ask" after prog ask, or "" for the program itself.
+struct Scope {
+  std::string path;
+  const std::vector<CompletionTable::Flag> &flags;
+  const std::vector<CompletionTable::Command> &commands;
+};
+
+inline void
+collect_scopes(std::vector<Scope> &scopes, const std::string &path,
+               const std::vector<CompletionTable::Flag> &flags,
+               const std::vector<CompletionTable::Command> &commands) {
+  scopes.push_back({path, flags, commands});
+  for (const CompletionTable::Command &command : commands) {
+    collect_scopes(scopes, path + "/" + command.name, command.flags,
+                   command.commands);
+  }
+}
+
+inline std::string command_names(
+    const std::vector<CompletionTable::Command> &commands) {
+  std::string names;
+  for (const CompletionTable::Command &command : commands) {
+    names += names.empty() ? "" : " ";
+    names += command.name;
+  }
+  return names;
+}
+
+inline void write_bash_scope(std::ostream &out, const Scope &scope,
+                             std::string_view indent) {
+  // a parameter is completed from the flag's values, or else as a file name,
+  // unless it starts a new flag
+  std::string takes_files;
+  std::string takes_values;
+  for (const CompletionTable::Flag &flag : scope.flags) {
+    if (flag.param_count == FlagParamSize::EMPTY) {
+      continue;
+    }
+    std::string pattern = "--" + flag.name;
+    if (flag.alias.has_value()) {
+      pattern += "|-";
+      pattern += *flag.alias;
+    }
+    if (flag.values.empty()) {
+      takes_files += takes_files.empty() ? "" : "|";
+      takes_files += pattern;
+    } else {
+      takes_values += std::string{indent} + "    " + pattern + ")\n";
+      takes_values += std::string{indent} + "      COMPREPLY=($(compgen -W ";
+      takes_values += "'" + flag.values + "'";
+      takes_values += " -- \"$cur\"))\n";
+      takes_values += std::string{indent} + "      return;;\n";
+    }
+  }
+  if (!takes_files.empty() || !takes_values.empty()) {
+    out << indent << "if [[ $cur != -* ]]; then\n";
+    out << indent << "  case $prev in\n";
+    out << takes_values;
+    if (!takes_files.empty()) {
+      out << indent << "    " << takes_files << ")\n";
+      out << indent << "      COMPREPLY=($(compgen -f -- \"$cur\"))\n";
+      out << indent << "      return;;\n";
+    }
+    out << indent << "  esac\n";
+    out << indent << "fi\n";
+  }
+  out << indent << "local words=";
+  std::string words;
+  for (const CompletionTable::Flag &flag : scope.flags) {
+    words += words.empty() ? "" : " ";
+    words += "--" + flag.name;
+    if (flag.alias.has_value()) {
+      words += " -";
+      words += *flag.alias;
+    }
+  }
+  if (!scope.commands.empty()) {
+    words += " " + command_names(scope.commands);
+  }
+  write_quoted(out, words);
+  out << '\n';
+  out << indent << "COMPREPLY=($(compgen -W \"$words\" -- \"$cur\"))\n";
+}
+
+inline void write_bash(std::ostream &out, const CompletionTable &table) {
+  std::string function = function_name(table.program);
+  out << function << "() {\n";
+  out << "  local cur=${COMP_WORDS[COMP_CWORD]}\n";
+  out << "  local prev=${COMP_WORDS[COMP_CWORD-1]}\n";
+  std::vector<Scope> scopes;
+  collect_scopes(scopes, "", table.flags, table.commands);
+  if (scopes.size() == 1) {
+    write_bash_scope(out, scopes[0], "  ");
+  } else {
+    // as when parsing, a word naming a subcommand of the one before selects
+    // it, unless a flag with a fixed number of parameters takes it
+    std::string paths;
+    std::map<uint32_t, std::string> skips;
+    for (const Scope &scope : scopes) {
+      if (!scope.path.empty()) {
+        paths += paths.empty() ? "" : "|";
+        paths += "'" + scope.path + "'";
+      }
+      for (const CompletionTable::Flag &flag : scope.flags) {
+        if (flag.param_count == FlagParamSize::EMPTY ||
+            flag.param_count == FlagParamSize::VARIADIC) {
+          continue;
+        }
+        std::string &skip = skips[flag.param_count];
+        skip += skip.empty() ? "" : "|";
+        skip += "'" + scope.path + "/--" + flag.name + "'";
+        if (flag.alias.has_value()) {
+          skip += "|'" + scope.path + "/-" + *flag.alias + "'";
+        }
+      }
+    }
+    out << "  local command= i\n";
+    out << "  for ((i = 1; i < COMP_CWORD; i++)); do\n";
+    out << "    case $command/${COMP_WORDS[i]} in\n";
+    out << "      " << paths << ")\n";
+    out << "        command+=/${COMP_WORDS[i]};;\n";
+    for (const auto &[count, skip] : skips) {
+      out << "      " << skip << ")\n";
+      out << "        ((i += " << count << "));;\n";
+    }
+    out << "    esac\n";
+    out << "  done\n";
+    out << "  case $command in\n";
+    for (const Scope &scope : scopes) {
+      out << "    '" << scope.path << "')\n";
+      write_bash_scope(out, scope, "      ");
+      out << "      ;;\n";
+    }
+    out << "  esac\n";
+  }
+  out << "}\n";
+  out << "complete -F " << function << ' ';
+  write_quoted(out, table.program);
+  out << '\n';
+}
+
+// Escapes the characters that _arguments gives a meaning to in a spec.
+inline std::string zsh_escape(std::string_view str) {
+  std::string escaped;
+  for (char c : str) {
+    if (c == '[' || c == ']' || c == ':' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+// Each subcommand gets a function of its own, which the parent's calls with
+// the words from the subcommand's name on.
+inline void
+write_zsh_scope(std::ostream &out, const std::string &function,
+                const std::vector<CompletionTable::Flag> &flags,
+                const std::vector<CompletionTable::Command> &commands) {
+  out << function << "() {\n";
+  if (!commands.empty()) {
+    out << "  local state\n";
+  }
+  out << "  _arguments -s";
+  if (!commands.empty()) {
+    out << " -C";
+  }
+  for (const CompletionTable::Flag &flag : flags) {
+    std::string action =
+        flag.values.empty() ? "_files" : "(" + flag.values + ")";
+    std::string params;
+    if (flag.param_count == FlagParamSize::VARIADIC) {
+      params = ":*:" + zsh_escape(flag.name) + ":" + action;
+    } else {
+      for (uint32_t i = 0; i < flag.param_count; i++) {
+        params += ":" + zsh_escape(flag.name) + ":" + action;
+      }
+    }
+    std::string description = "[" + zsh_escape(flag.description) + "]";
+    out << " \\\n    ";
+    write_quoted(out, "--" + flag.name + description + params);
+    if (flag.alias.has_value()) {
+      out << " \\\n    ";
+      write_quoted(out, std::string{"-"} + *flag.alias + description +
+                            params);
+    }
+  }
+  if (!commands.empty()) {
+    out << " \\\n    ";
+    write_quoted(out, "1:command:(" + command_names(commands) + ")");
+    out << " \\\n    ";
+    write_quoted(out, "*::arg:->args");
+    out << "\n  case $state in\n";
+    out << "    args)\n";
+    out << "      case $words[1] in\n";
+    for (const CompletionTable::Command &command : commands) {
+      out << "        ";
+      write_quoted(out, command.name);
+      out << ") " << function_name(function + " " + command.name) << ";;\n";
+    }
+    out << "      esac;;\n";
+    out << "  esac";
+  }
+  out << "\n}\n";
+  for (const CompletionTable::Command &command : commands) {
+    write_zsh_scope(out, function_name(function + " " + command.name),
+                    command.flags, command.commands);
+  }
+}
+
+inline void write_zsh(std::ostream &out, const CompletionTable &table) {
+  std::string function = function_name(table.program);
+  out << "#compdef " << table.program << '\n';
+  write_zsh_scope(out, function, table.flags, table.commands);
+  out << "compdef " << function << ' ';
+  write_quoted(out, table.program);
+  out << '\n';
+}
+
+// Flags and subcommands of a scope are only offered once the subcommands in
+// its path have been typed, and before any of its own.
+inline void write_fish(std::ostream &out, const CompletionTable &table) {
+  std::vector<Scope> scopes;
+  collect_scopes(scopes, "", table.flags, table.commands);
+  for (const Scope &scope : scopes) {
+    std::string condition;
+    std::string_view path = scope.path;
+    while (!path.empty()) {
+      path.remove_prefix(1);
+      std::size_t end = std::min(path.find('/'), path.size());
+      condition += condition.empty() ? "" : "; and ";
+      condition += "__fish_seen_subcommand_from ";
+      condition += path.substr(0, end);
+      path.remove_prefix(end);
+    }
+    if (!scope.commands.empty()) {
+      condition += condition.empty() ? "" : "; and ";
+      condition += "not __fish_seen_subcommand_from ";
+      condition += command_names(scope.commands);
+    }
+    auto complete = [&] {
+      out << "complete -c ";
+      write_quoted(out, table.program, true);
+      if (!condition.empty()) {
+        out << " -n ";
+        write_quoted(out, condition, true);
+      }
+    };
+    for (const CompletionTable::Flag &flag : scope.flags) {
+      complete();
+      out << " -l ";
+      write_quoted(out, flag.name, true);
+      if (flag.alias.has_value()) {
+        out << " -s ";
+        write_quoted(out, std::string(1, *flag.alias), true);
+      }
+      if (flag.param_count != FlagParamSize::EMPTY) {
+        if (flag.values.empty()) {
+          out << " -r -F";
+        } else {
+          out << " -x -a ";
+          write_quoted(out, flag.values, true);
+        }
+      }
+      out << " -d ";
+      write_quoted(out, flag.description, true);
+      out << '\n';
+    }
+    for (const CompletionTable::Command &command : scope.commands) {
+      complete();
+      out << " -f -a ";
+      write_quoted(out, command.name, true);
+      out << " -d ";
+      write_quoted(out, command.description, true);
+      out << '\n';
+    }
+  }
+}
+
+} // namespace completion
+
+// Returns false if shell is not one of CompletionShells.
+inline bool write_completion(std::ostream &out, std::string_view shell,
+                             const CompletionTable &table) {
+  if (shell == CompletionShells::bash) {
+    completion::write_bash(out, table);
+  } else if (shell == CompletionShells::zsh) {
+    completion::write_zsh(out, table);
+  } else if (shell == CompletionShells::fish) {
+    completion::write_fish(out, table);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+} // namespace quikcli
+
+#endif // QC_COMPLETION_H_
@@ -28,26 +28,35 @@
 #ifndef QC_COMPONENT_H_
 #define QC_COMPONENT_H_
 
-#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
+#include "quikcli/function.h"
 #include "quikcli/writer.h"
 
 namespace quikcli {
 
 class Loader;
+class ProgressBoard;
 
-using empty_callback_t = std::function<void()>;
-using str_callback_t = std::function<void(std::string &)>;
-using str_vec_callback_t = std::function<void(std::vector<std::string> &)>;
+using empty_callback_t = InplaceFunction<void()>;
+using str_callback_t = InplaceFunction<void(std::string &)>;
+using str_vec_callback_t = InplaceFunction<void(std::vector<std::string> &)>;
 
-using loader_trigger_t = std::function<void(Loader &)>;
+using loader_trigger_t = InplaceFunction<void(Loader &)>;
+using board_trigger_t = InplaceFunction<void(ProgressBoard &)>;
 
 class Component {
 public:
   Component() {}
-  ~Component() = default;
+  virtual ~Component() = default;
 
   Component(Component &) = default;
   Component &operator=(Component &) = default;
@@ -55,6 +64,7 @@ public:
   Component &operator=(Component &&) = default;
 
   virtual void run(Writer &writer) = 0;
+  virtual const char *name() const { return "Component"; }
 };
 
 class Display : public Component {
@@ -73,62 +83,304 @@ public:
 public:
   void run(Writer &writer) override {
     writer.out(outputs_);
+    auto span = writer.trace("Display callback");
     callback_();
   };
+  const char *name() const override { return "Display"; }
 
 private:
   std::vector<std::string> outputs_;
   empty_callback_t callback_;
 };
 
+// Lays out a progress bar of the form "[====>    ]  42%" across width cells.
+// The percentage is rounded, but only reads 100% once progress is complete.
+inline void draw_bar(std::string &output, std::size_t width, double progress) {
+  int percent =
+      progress >= 1.0 ? 100 : std::min(99L, std::lround(100 * progress));
+  output.assign(width, ' ');
+  if (width < 8) {
+    // the '%' goes first; cut digits would misread
+    output = std::to_string(percent) + '%';
+    if (output.size() > width) {
+      output.pop_back();
+    }
+    if (output.size() > width) {
+      output.assign(width, ' ');
+    }
+    return;
+  }
+  std::size_t cells = width - 7;
+  std::size_t filled = cells * progress;
+  output[0] = '[';
+  output.replace(1, filled, filled, '=');
+  if (filled < cells) {
+    output[filled + 1] = '>';
+  }
+  output[width - 6] = ']';
+  std::string digits = std::to_string(percent);
+  output.replace(width - 1 - digits.size(), digits.size(), digits);
+  output[width - 1] = '%';
+}
+
 class Loader : public Component {
 public:
+  /* Constructors & Destructors - No Copy No Move */
   Loader(loader_trigger_t trigger) : Loader(std::move(trigger), [] {}) {}
   Loader(loader_trigger_t trigger, empty_callback_t callback)
       : trigger_{std::move(trigger)}, callback_{std::move(callback)} {}
 
-  Loader(Loader &) = default;
-  Loader &operator=(Loader &) = default;
-  Loader(Loader &&) = default;
-  Loader &operator=(Loader &&) = default;
+  Loader(Loader &) = delete;
+  Loader &operator=(Loader &) = delete;
+  Loader(Loader &&) = delete;
+  Loader &operator=(Loader &&) = delete;
 
 public:
-  // TODO: Add check on terminal width & find better way to signal update
+  /* Configuration */
+  // Caps how often the bar is redrawn; updates in between are coalesced into
+  // the next frame. A rate of 0 redraws on every update.
+  Loader &set_max_frame_rate(uint32_t frame_rate) {
+    frame_interval_ = frame_rate == 0 ? std::chrono::nanoseconds::zero()
+                                      : std::chrono::nanoseconds{
+                                            std::chrono::seconds{1}} /
+                                            frame_rate;
+    return *this;
+  }
+
+  // The bar is laid out again only when the progress or the terminal width
+  // has changed since the last frame. Lines logged meanwhile are printed above
+  // it as they arrive.
   void run(Writer &writer) override {
-    trigger_(*this);
-    unsigned short width = writer.width();
+    Wake &wake = writer.wake();
+    wake_.store(&wake);
+    {
+      auto span = writer.trace("Loader trigger");
+      trigger_(*this);
+    }
     std::string output;
-    output.resize(width, ' ');
-    output[0] = '[';
-    output[width - 6] = ']';
-    output[width - 1] = '%';
-    while (progress_ < 1.0) {
-      if (update_) {
-        int bar_progress = (width - 6) * progress_;
-        int int_progress = 100 * progress_;
-        output.replace(1, bar_progress, bar_progress, '=');
-        output[bar_progress + 1] = '>';
-        output.replace(width - 4, 2, std::to_string(int_progress));
+    double drawn = -1;
+    std::size_t drawn_width = 0;
+    ProgressThrottle throttle = writer.progress_throttle();
+    while (true) {
+      uint32_t epoch = wake.epoch();
+      dirty_.store(false);
+      double progress = progress_.load();
+      std::size_t width = writer.width();
+      if (writer.structured()) {
+        if (throttle.pass(progress)) {
+          writer.progress(name(), progress);
+        }
+      } else if (!writer.headless() &&
+                 (progress != drawn || width != drawn_width)) {
+        draw_bar(output, width, progress);
         writer.reset_cursor();
         writer.out(output);
-        update_ = false;
+        drawn = progress;
+        drawn_width = width;
+      }
+      writer.flush_logs();
+      if (progress >= 1.0) {
+        break;
+      }
+      auto next_frame = std::chrono::steady_clock::now() + frame_interval_;
+      wake.wait(epoch);
+      // headless, there are no frames to pace
+      if (!writer.headless()) {
+        std::this_thread::sleep_until(next_frame);
       }
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    while (updating_.load() != 0) {
+      std::this_thread::yield();
     }
     writer.newline();
+    auto span = writer.trace("Loader callback");
     callback_();
   };
+  const char *name() const override { return "Loader"; }
 
   void update(double progress) {
-    progress_ = progress;
-    update_ = true;
+    // run() returns as soon as it sees the final progress, so it first waits
+    // out updates still in flight, which touch the loader after the store
+    updating_.fetch_add(1);
+    progress_.store(std::clamp(progress, 0.0, 1.0));
+    // only the first update since the last frame needs to wake it
+    if (!dirty_.load() && !dirty_.exchange(true)) {
+      if (Wake *wake = wake_.load()) {
+        wake->notify();
+      }
+    }
+    updating_.fetch_sub(1);
   }
 
 private:
   loader_trigger_t trigger_;
   empty_callback_t callback_;
-  double progress_ = 0;
-  bool update_ = false;
+  std::chrono::nanoseconds frame_interval_ =
+      std::chrono::nanoseconds{std::chrono::seconds{1}} / 30;
+  std::atomic<double> progress_ = 0;
+  std::atomic<bool> dirty_ = false;
+  std::atomic<uint32_t> updating_ = 0;
+  // the writer's, once run
+  std::atomic<Wake *> wake_ = nullptr;
+};
+
+// Renders a set of named bars as one block. Every bar lives in its own cache
+// line and is written through a Handle, so workers never share a lock; the
+// only shared state they touch is a dirty flag that is read far more often
+// than it is written.
+class ProgressBoard : public Component {
+private:
+  struct alignas(64) Slot {
+    std::atomic<double> progress = 0;
+    // kept per slot, so that workers do not contend on it
+    std::atomic<uint32_t> updating = 0;
+  };
+
+public:
+  class Handle {
+  public:
+    void update(double progress) { board_->update(*slot_, progress); }
+
+  private:
+    friend class ProgressBoard;
+    Handle(ProgressBoard *board, Slot *slot) : board_{board}, slot_{slot} {}
+
+    ProgressBoard *board_;
+    Slot *slot_;
+  };
+
+  /* Constructors & Destructors - No Copy No Move */
+  ProgressBoard(std::vector<std::string> names, board_trigger_t trigger)
+      : ProgressBoard(std::move(names), std::move(trigger), [] {}) {}
+  ProgressBoard(std::vector<std::string> names, board_trigger_t trigger,
+                empty_callback_t callback)
+      : names_{std::move(names)}, slots_{new Slot[names_.size()]},
+        trigger_{std::move(trigger)}, callback_{std::move(callback)} {}
+
+  ProgressBoard(ProgressBoard &) = delete;
+  ProgressBoard &operator=(ProgressBoard &) = delete;
+  ProgressBoard(ProgressBoard &&) = delete;
+  ProgressBoard &operator=(ProgressBoard &&) = delete;
+
+public:
+  /* Getters */
+  std::size_t size() const { return names_.size(); }
+  Handle handle(std::size_t index) { return Handle{this, &slots_[index]}; }
+
+  /* Configuration */
+  ProgressBoard &set_max_frame_rate(uint32_t frame_rate) {
+    frame_interval_ = frame_rate == 0 ? std::chrono::nanoseconds::zero()
+                                      : std::chrono::nanoseconds{
+                                            std::chrono::seconds{1}} /
+                                            frame_rate;
+    return *this;
+  }
+
+  void run(Writer &writer) override {
+    Wake &wake = writer.wake();
+    wake_.store(&wake);
+    {
+      auto span = writer.trace("ProgressBoard trigger");
+      trigger_(*this);
+    }
+    std::size_t longest = 0;
+    for (const std::string &name : names_) {
+      longest = std::max(longest, name.size());
+    }
+    std::size_t width = 0;
+    std::size_t label_width = 0;
+    std::size_t bar_width = 0;
+    std::vector<std::string> outputs(size());
+    std::vector<double> drawn(size(), -1);
+    std::vector<ProgressThrottle> throttles(size(), writer.progress_throttle());
+    std::string bar;
+    std::string row;
+    while (true) {
+      // only a change of width reflows the bars that have not moved
+      if (std::size_t now = writer.width(); now != width) {
+        width = now;
+        // long names are cut short to leave the bars at least half the row
+        label_width = std::min(longest, width / 2);
+        bar_width = width > label_width + 1 ? width - label_width - 1 : 0;
+        std::fill(drawn.begin(), drawn.end(), -1);
+      }
+      uint32_t epoch = wake.epoch();
+      dirty_.store(false);
+      bool done = true;
+      writer.begin_frame();
+      for (std::size_t i = 0; i < size(); i++) {
+        double progress = slots_[i].progress.load();
+        done = done && progress >= 1.0;
+        if (writer.headless()) {
+          continue;
+        }
+        if (writer.structured()) {
+          if (throttles[i].pass(progress)) {
+            writer.progress(names_[i], progress);
+          }
+          continue;
+        }
+        if (progress == drawn[i]) {
+          continue;
+        }
+        draw_bar(bar, bar_width, progress);
+        row.clear();
+        Writer::fit(row, names_[i], label_width);
+        row.resize(std::max(row.size(), label_width), ' ');
+        row += ' ';
+        row += bar;
+        // a row that wrapped would throw off the redraw of the ones below
+        outputs[i].clear();
+        Writer::fit(outputs[i], row, width);
+        drawn[i] = progress;
+      }
+      if (!writer.structured() && !writer.headless()) {
+        writer.reset_cursor();
+        writer.out(outputs);
+      }
+      writer.flush_logs();
+      writer.end_frame();
+      if (done) {
+        break;
+      }
+      auto next_frame = std::chrono::steady_clock::now() + frame_interval_;
+      wake.wait(epoch);
+      if (!writer.headless()) {
+        std::this_thread::sleep_until(next_frame);
+      }
+    }
+    for (std::size_t i = 0; i < size(); i++) {
+      while (slots_[i].updating.load() != 0) {
+        std::this_thread::yield();
+      }
+    }
+    writer.newline();
+    auto span = writer.trace("ProgressBoard callback");
+    callback_();
+  };
+  const char *name() const override { return "ProgressBoard"; }
+
+private:
+  void update(Slot &slot, double progress) {
+    slot.updating.fetch_add(1);
+    slot.progress.store(std::clamp(progress, 0.0, 1.0));
+    if (!dirty_.load() && !dirty_.exchange(true)) {
+      if (Wake *wake = wake_.load()) {
+        wake->notify();
+      }
+    }
+    slot.updating.fetch_sub(1);
+  }
+
+private:
+  std::vector<std::string> names_;
+  std::unique_ptr<Slot[]> slots_;
+  board_trigger_t trigger_;
+  empty_callback_t callback_;
+  std::chrono::nanoseconds frame_interval_ =
+      std::chrono::nanoseconds{std::chrono::seconds{1}} / 30;
+  alignas(64) std::atomic<bool> dirty_ = false;
+  std::atomic<Wake *> wake_ = nullptr;
 };
 
 } // namespace quikcli
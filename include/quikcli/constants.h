@@ -28,12 +28,15 @@
 #ifndef QC_CONSTANTS_H_
 #define QC_CONSTANTS_H_
 
+#include <cstddef>
 #include <cstdint>
+
 namespace quikcli {
 
 struct DefaultFlagNames {
   static constexpr char version[] = "version";
   static constexpr char help[] = "help";
+  static constexpr char completion[] = "completion";
 };
 
 struct DefaultFlagAliases {
@@ -44,6 +47,14 @@ struct DefaultFlagAliases {
 struct DefaultFlagDescription {
   static constexpr char version[] = "print version information then exit.";
   static constexpr char help[] = "print help message then exit.";
+  static constexpr char completion[] =
+      "print a bash, zsh or fish completion script then exit.";
+};
+
+struct CompletionShells {
+  static constexpr char bash[] = "bash";
+  static constexpr char zsh[] = "zsh";
+  static constexpr char fish[] = "fish";
 };
 
 struct FlagParamSize {
@@ -51,6 +62,23 @@ struct FlagParamSize {
   static constexpr uint32_t VARIADIC = 0xFFFFFFFF;
 };
 
+struct ResponseFileDefaults {
+  static constexpr char prefix = '@';
+  static constexpr uint32_t max_depth = 8;
+};
+
+struct KeyReaderDefaults {
+  // how long a lone ESC waits for the rest of a sequence split across reads
+  static constexpr int escape_timeout_ms = 30;
+  // longest unterminated sequence held over before it is given up on
+  static constexpr std::size_t max_escape = 32;
+};
+
+struct InplaceFunctionDefaults {
+  // bytes of inline storage for a callable
+  static constexpr std::size_t capacity = 64;
+};
+
 } // namespace quikcli
 
 #endif // QC_CONSTANTS_H_
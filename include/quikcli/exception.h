@@ -37,6 +37,7 @@ enum class ExceptionType : uint8_t {
   UNKNOWN = 0,
   CONFIGURATION = 1,
   PARSER = 2,
+  IO = 3,
 };
 
 class Exception : public std::runtime_error {
@@ -53,6 +54,9 @@ public:
       case ExceptionType::PARSER: {
         return "Parser";
       };
+      case ExceptionType::IO: {
+        return "IO";
+      };
       default: {
         return "Unknown";
       }
@@ -28,43 +28,111 @@
 #ifndef QC_FLAG_H_
 #define QC_FLAG_H_
 
+#include <array>
+#include <charconv>
 #include <concepts>
 #include <cstdint>
-#include <functional>
+#include <memory>
+#include <memory_resource>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <string>
-#include <unordered_set>
+#include <string_view>
+#include <system_error>
 #include <vector>
 
 #include "quikcli/constants.h"
 #include "quikcli/exception.h"
+#include "quikcli/function.h"
 
 namespace quikcli {
+class Flag;
 class QuikCli;
 
-using flag_callback_t = std::function<void(std::vector<std::string> &)>;
+using flag_params_t = std::span<const std::string_view>;
+using flag_callback_t = InplaceFunction<void(flag_params_t)>;
+// Returns the index of the first parameter that could not be converted, or
+// Flag::npos.
+using flag_converter_t = InplaceFunction<std::size_t(flag_params_t)>;
+using alias_table_t = std::array<Flag *, 128>;
 
 template <class Param>
-concept has_istream_operator = requires(Param &param) {
-  { std::declval<std::istream &>() >> param } -> std::same_as<std::istream>;
+concept has_istream_operator = requires(std::istream &stream, Param &param) {
+  { stream >> param } -> std::convertible_to<std::istream &>;
 };
 
+// Arithmetic types std::from_chars can read. Character types are left to the
+// stream, which reads them as a single character rather than a number.
+template <class Param>
+concept has_from_chars =
+    std::floating_point<Param> ||
+    (std::integral<Param> && !std::same_as<Param, bool> &&
+     !std::same_as<Param, char> && !std::same_as<Param, signed char> &&
+     !std::same_as<Param, unsigned char>);
+
+/* Parameter Conversion */
+template <class Param>
+  requires has_istream_operator<Param>
+bool stream_param(std::string_view input, Param &output) {
+  std::istringstream arg_stream{std::string{input}};
+  arg_stream >> output;
+  return arg_stream && arg_stream.peek() == std::char_traits<char>::eof();
+}
+
+template <class Param>
+  requires has_istream_operator<Param>
+bool convert_param(std::string_view input, Param &output) {
+  if constexpr (std::same_as<Param, std::string>) {
+    output.assign(input);
+    return true;
+  } else if constexpr (has_from_chars<Param>) {
+    // streams accept an explicit plus sign, from_chars does not
+    if (input.starts_with('+') && !input.starts_with("+-")) {
+      input.remove_prefix(1);
+    }
+    const char *end = input.data() + input.size();
+    auto [ptr, ec] = std::from_chars(input.data(), end, output);
+    return ec == std::errc{} && ptr == end;
+  } else {
+    return stream_param(input, output);
+  }
+}
+
 class Flag {
 public:
+  static constexpr std::size_t npos = -1;
+
+  // Flags made by QuikCli keep their strings in its memory resource.
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
   /* Constructors & Destructors - No Copy Default Move */
-  Flag(std::string name, std::string description)
-      : Flag(FlagParamSize::EMPTY, std::move(name), std::move(description),
-             process_empty) {}
-  Flag(std::string name, std::string description, flag_callback_t callback)
-      : Flag(FlagParamSize::VARIADIC, std::move(name), std::move(description),
-             std::move(callback)) {}
+  Flag(std::string_view name, std::string_view description)
+      : Flag(std::allocator_arg, {}, name, description) {}
+  Flag(std::string_view name, std::string_view description,
+       flag_callback_t callback)
+      : Flag(std::allocator_arg, {}, name, description, std::move(callback)) {}
+  template <class... ParamsT>
+    requires(has_istream_operator<ParamsT> && ...)
+  Flag(std::string_view name, std::string_view description, ParamsT &...params)
+      : Flag(std::allocator_arg, {}, name, description, params...) {}
+
+  Flag(std::allocator_arg_t, const allocator_type &allocator,
+       std::string_view name, std::string_view description)
+      : Flag(allocator, FlagParamSize::EMPTY, name, description,
+             process_empty, nullptr) {}
+  Flag(std::allocator_arg_t, const allocator_type &allocator,
+       std::string_view name, std::string_view description,
+       flag_callback_t callback)
+      : Flag(allocator, FlagParamSize::VARIADIC, name, description,
+             std::move(callback), nullptr) {}
   template <class... ParamsT>
     requires(has_istream_operator<ParamsT> && ...)
-  Flag(std::string name, std::string description, ParamsT &...params)
-      : Flag(sizeof...(params), std::move(name), std::move(description),
-             [&](std::vector<std::string> &inputs) {
-               process_params(inputs, params...);
+  Flag(std::allocator_arg_t, const allocator_type &allocator,
+       std::string_view name, std::string_view description, ParamsT &...params)
+      : Flag(allocator, sizeof...(params), name, description, nullptr,
+             [&](flag_params_t inputs) {
+               return process_params(inputs, params...);
              }) {}
 
   Flag(Flag &) = delete;
@@ -77,86 +145,129 @@ public:
 public:
   /* Getters */
   bool is_set() const { return is_set_; }
-  std::string name() const { return name_; }
-  std::string description() const { return description_; }
+  std::string name() const { return std::string{name_}; }
+  std::string description() const { return std::string{description_}; }
   std::optional<char> alias() const { return alias_; }
+  uint32_t param_count() const { return param_count_; }
 
   /* Configuration */
   Flag &set_immediate_parse() {
     immediate_parse_ = true;
     return *this;
   }
+  // Hands the parameters of a variadic flag to its callback in chunks of up
+  // to size as they are parsed, rather than all at once afterwards, so they
+  // need not all be held in memory. The views in a chunk only last until the
+  // callback returns.
+  Flag &set_chunk_size(std::size_t size) {
+    chunk_size_ = size;
+    return *this;
+  }
+  // The deferred callback runs only after that of the named flag has
+  // returned, if both were set; it is skipped if that one failed.
+  Flag &depends_on(std::string_view name) {
+    dependencies_.emplace_back(name);
+    return *this;
+  }
   Flag &set_param_count(uint32_t param_count) {
     param_count_ = param_count;
     return *this;
   }
   Flag &set_alias(char alias) {
-    if (alias_set_.contains(alias)) {
+    if (alias <= 0) {
       throw Exception(ExceptionType::CONFIGURATION,
-                      "alias -" + std::to_string(alias) +
-                          " has already been assigned.");
+                      "alias -" + std::string{alias} + " is not ascii.");
+    }
+    if (aliases_) {
+      if ((*aliases_)[alias]) {
+        throw Exception(ExceptionType::CONFIGURATION,
+                        "alias -" + std::string{alias} +
+                            " has already been assigned.");
+      }
+      if (alias_.has_value()) {
+        (*aliases_)[alias_.value()] = nullptr;
+      }
+      (*aliases_)[alias] = this;
     }
     alias_.emplace(alias);
     return *this;
   }
 
   /* Parsing */
-  void set(std::vector<std::string> params) {
-    if (param_count_ != FlagParamSize::VARIADIC &&
-        params.size() != param_count_) {
-      throw Exception(ExceptionType::PARSER,
-                      "expected " + std::to_string(param_count_) +
-                          " arguments, got " + std::to_string(params.size()) +
-                          ".");
+  bool accepts(std::size_t param_count) const {
+    return param_count_ == FlagParamSize::VARIADIC ||
+           param_count == param_count_;
+  }
+  // params must outlive the flag's callback; the parser keeps them as views
+  // into argv. set() and parse() return the index of the first parameter that
+  // could not be converted, or npos.
+  std::size_t set(flag_params_t params) {
+    if (is_streamed()) {
+      // the callback has already been called if any chunks were streamed
+      if (!is_set_ || !params.empty()) {
+        callback_(params);
+      }
+      is_set_ = true;
+      return npos;
     }
     params_ = params;
     is_set_ = true;
-    if (immediate_parse_) {
-      callback_(params_);
-    }
+    return immediate_parse_ ? invoke(params_) : npos;
   }
-  void parse() {
-    if (!immediate_parse_) {
-      callback_(params_);
-    }
+  void stream(flag_params_t chunk) {
+    is_set_ = true;
+    callback_(chunk);
+  }
+  std::size_t parse() {
+    return immediate_parse_ || is_streamed() ? npos : invoke(params_);
   }
 
 private:
-  Flag(uint32_t param_count, std::string name, std::string description,
-       flag_callback_t callback)
-      : param_count_{param_count}, name_(name), description_{description},
-        callback_{callback} {}
+  Flag(const allocator_type &allocator, uint32_t param_count,
+       std::string_view name, std::string_view description,
+       flag_callback_t callback, flag_converter_t converter)
+      : param_count_{param_count}, name_{name, allocator},
+        description_{description, allocator}, callback_{std::move(callback)},
+        converter_{std::move(converter)}, dependencies_{allocator} {}
+
+  std::size_t invoke(flag_params_t params) {
+    if (converter_) {
+      return converter_(params);
+    }
+    callback_(params);
+    return npos;
+  }
+  bool is_streamed() const {
+    return chunk_size_ > 0 && param_count_ == FlagParamSize::VARIADIC;
+  }
 
   template <class... ParamsT>
     requires(has_istream_operator<ParamsT> && ...)
-  static void process_params(std::vector<std::string> &inputs,
-                             ParamsT &...outputs) {
-    uint32_t idx = 0;
-    (
-        [&] {
-          std::istringstream arg_stream(inputs[idx++]);
-          arg_stream >> outputs;
-          if (!arg_stream ||
-              arg_stream.peek() != std::char_traits<char>::eof()) {
-            throw Exception(ExceptionType::PARSER,
-                            "failed to parse argument " + inputs[idx - 1]);
-          }
-        }(),
-        ...);
+  static std::size_t process_params(flag_params_t inputs,
+                                    ParamsT &...outputs) {
+    std::size_t idx = 0;
+    bool converted = (convert_param(inputs[idx++], outputs) && ...);
+    return converted ? npos : idx - 1;
   }
-  static void process_empty(std::vector<std::string> &) { /* do nothing */ }
+  static void process_empty(flag_params_t) { /* do nothing */ }
 
 private:
   bool is_set_ = false;
   bool immediate_parse_ = false;
   uint32_t param_count_;
-  std::string name_;
+  std::size_t chunk_size_ = 0;
+  std::pmr::string name_;
   std::optional<char> alias_;
-  std::string description_;
+  std::pmr::string description_;
   flag_callback_t callback_;
-  std::vector<std::string> params_;
+  flag_converter_t converter_;
+  flag_params_t params_;
+  std::pmr::vector<std::pmr::string> dependencies_;
+  alias_table_t *aliases_ = nullptr;
+  // position in the QuikCli's flags, for validation
+  std::size_t index_ = 0;
 
-  inline static std::unordered_set<char> alias_set_{};
+  friend class QuikCli;
 };
 
 } // namespace quikcli
@@ -0,0 +1,167 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_FUNCTION_H_
+#define QC_FUNCTION_H_
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "quikcli/constants.h"
+
+namespace quikcli {
+
+template <class Signature,
+          std::size_t Capacity = InplaceFunctionDefaults::capacity>
+class InplaceFunction;
+
+// A copyable callable wrapper like std::function that keeps the callable in
+// Capacity bytes of its own storage and never allocates. A callable that does
+// not fit is rejected at compile time; capture by reference instead.
+template <class R, class... Args, std::size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+public:
+  /* Constructors & Destructors - Default Copy Default Move */
+  InplaceFunction() = default;
+  InplaceFunction(std::nullptr_t) {}
+  template <class F>
+    requires(!std::same_as<std::remove_cvref_t<F>, InplaceFunction> &&
+             std::is_invocable_r_v<R, std::decay_t<F> &, Args...>)
+  InplaceFunction(F &&callable) {
+    using Callable = std::decay_t<F>;
+    static_assert(sizeof(Callable) <= Capacity,
+                  "callable is too large for InplaceFunction.");
+    static_assert(alignof(Callable) <= alignof(std::max_align_t),
+                  "callable is over-aligned for InplaceFunction.");
+    static_assert(std::is_copy_constructible_v<Callable>,
+                  "InplaceFunction requires a copyable callable.");
+    if constexpr (std::is_pointer_v<std::remove_cvref_t<F>>) {
+      if (!callable) {
+        return;
+      }
+    }
+    ::new (static_cast<void *>(storage_)) Callable(std::forward<F>(callable));
+    ops_ = &ops_for<Callable>;
+  }
+  ~InplaceFunction() { reset(); }
+
+  InplaceFunction(const InplaceFunction &other) : ops_{other.ops_} {
+    if (ops_) {
+      ops_->copy(storage_, other.storage_);
+    }
+  }
+  InplaceFunction &operator=(const InplaceFunction &other) {
+    if (this != &other) {
+      reset();
+      if (other.ops_) {
+        other.ops_->copy(storage_, other.storage_);
+        ops_ = other.ops_;
+      }
+    }
+    return *this;
+  }
+  InplaceFunction(InplaceFunction &&other) noexcept : ops_{other.ops_} {
+    if (ops_) {
+      ops_->move(storage_, other.storage_);
+      other.ops_ = nullptr;
+    }
+  }
+  InplaceFunction &operator=(InplaceFunction &&other) noexcept {
+    if (this != &other) {
+      reset();
+      if (other.ops_) {
+        other.ops_->move(storage_, other.storage_);
+        ops_ = other.ops_;
+        other.ops_ = nullptr;
+      }
+    }
+    return *this;
+  }
+  InplaceFunction &operator=(std::nullptr_t) {
+    reset();
+    return *this;
+  }
+
+public:
+  explicit operator bool() const { return ops_ != nullptr; }
+  R operator()(Args... args) const {
+    if (!ops_) {
+      throw std::bad_function_call();
+    }
+    return ops_->invoke(storage_, std::forward<Args>(args)...);
+  }
+
+private:
+  // One table per callable type; move leaves the source destroyed.
+  struct Ops {
+    R (*invoke)(void *, Args &&...);
+    void (*copy)(void *, const void *);
+    void (*move)(void *, void *);
+    void (*destroy)(void *);
+  };
+
+  template <class Callable>
+  static constexpr Ops ops_for{
+      [](void *callable, Args &&...args) -> R {
+        if constexpr (std::is_void_v<R>) {
+          std::invoke(*static_cast<Callable *>(callable),
+                      std::forward<Args>(args)...);
+        } else {
+          return std::invoke(*static_cast<Callable *>(callable),
+                             std::forward<Args>(args)...);
+        }
+      },
+      [](void *to, const void *from) {
+        ::new (to) Callable(*static_cast<const Callable *>(from));
+      },
+      [](void *to, void *from) {
+        Callable *source = static_cast<Callable *>(from);
+        ::new (to) Callable(std::move(*source));
+        source->~Callable();
+      },
+      [](void *callable) { static_cast<Callable *>(callable)->~Callable(); },
+  };
+
+  void reset() {
+    if (ops_) {
+      ops_->destroy(storage_);
+      ops_ = nullptr;
+    }
+  }
+
+private:
+  alignas(std::max_align_t) mutable unsigned char storage_[Capacity];
+  const Ops *ops_ = nullptr;
+};
+
+} // namespace quikcli
+
+#endif // QC_FUNCTION_H_
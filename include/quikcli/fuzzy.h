@@ -0,0 +1,137 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_FUZZY_H_
+#define QC_FUZZY_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace quikcli {
+
+// Scores candidates that contain a query as a case-insensitive (ascii)
+// subsequence. Matches at word starts and runs of consecutive characters score
+// higher, gaps lower. The scan for each query character compares 16 bytes at
+// a time where SSE2 is available.
+class FuzzyMatcher {
+public:
+  static constexpr int no_match = -1;
+
+  explicit FuzzyMatcher(std::string_view query) {
+    for (char c : query) {
+      lower_ += to_lower(c);
+      upper_ += to_upper(c);
+    }
+  }
+
+public:
+  int score(std::string_view candidate) const {
+    if (lower_.empty()) {
+      return 0;
+    }
+    // find the earliest end of a match, then walk back from it for the
+    // latest start so the scored window is as tight as possible
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < lower_.size(); i++) {
+      pos = find(candidate, pos, lower_[i], upper_[i]);
+      if (pos == npos) {
+        return no_match;
+      }
+      pos++;
+    }
+    std::size_t end = pos;
+    std::size_t begin = end;
+    for (std::size_t i = lower_.size(); i-- > 0;) {
+      do {
+        begin--;
+      } while (candidate[begin] != lower_[i] && candidate[begin] != upper_[i]);
+    }
+    int score = 0;
+    std::size_t last = npos;
+    pos = begin;
+    for (std::size_t i = 0; i < lower_.size(); i++) {
+      pos = find(candidate.substr(0, end), pos, lower_[i], upper_[i]);
+      score += 16;
+      if (pos == 0 || is_separator(candidate[pos - 1])) {
+        score += 12;
+      }
+      if (last != npos) {
+        std::size_t gap = pos - last - 1;
+        score += gap == 0 ? 8 : -static_cast<int>(gap < 8 ? gap : 8);
+      }
+      last = pos++;
+    }
+    return score > 0 ? score : 0;
+  }
+
+private:
+  static constexpr std::size_t npos = std::string_view::npos;
+
+  static std::size_t find(std::string_view text, std::size_t from, char lower,
+                          char upper) {
+    const char *data = text.data();
+    std::size_t size = text.size();
+#if defined(__SSE2__)
+    __m128i lowers = _mm_set1_epi8(lower);
+    __m128i uppers = _mm_set1_epi8(upper);
+    for (; from + 16 <= size; from += 16) {
+      __m128i block =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + from));
+      int mask = _mm_movemask_epi8(_mm_or_si128(
+          _mm_cmpeq_epi8(block, lowers), _mm_cmpeq_epi8(block, uppers)));
+      if (mask != 0) {
+        return from + __builtin_ctz(mask);
+      }
+    }
+#endif
+    for (; from < size; from++) {
+      if (data[from] == lower || data[from] == upper) {
+        return from;
+      }
+    }
+    return npos;
+  }
+  static char to_lower(char c) { return c >= 'A' && c <= 'Z' ? c + 32 : c; }
+  static char to_upper(char c) { return c >= 'a' && c <= 'z' ? c - 32 : c; }
+  static bool is_separator(char c) {
+    return c == ' ' || c == '-' || c == '_' || c == '/' || c == '.' ||
+           c == ':';
+  }
+
+private:
+  std::string lower_;
+  std::string upper_;
+};
+
+} // namespace quikcli
+
+#endif // QC_FUZZY_H_
@@ -0,0 +1,256 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_INPUT_H_
+#define QC_INPUT_H_
+
+#include <csignal>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "quikcli/component.h"
+#include "quikcli/terminal.h"
+#include "quikcli/writer.h"
+
+namespace quikcli {
+
+// Prompts for a line of text. On a terminal the line is edited in raw mode
+// (arrows, home/end, backspace/delete, ctrl-a/e/k/u/w) and redrawn once per
+// batch of input; otherwise a line is read from stdin. A replayed session
+// supplies the line instead.
+class TextInput : public Component {
+public:
+  /* Constructors & Destructors - No Copy Default Move */
+  TextInput(std::string prompt, str_callback_t callback)
+      : prompt_{std::move(prompt)}, callback_{std::move(callback)} {}
+
+  TextInput(TextInput &) = delete;
+  TextInput &operator=(TextInput &) = delete;
+  TextInput(TextInput &&) = default;
+  TextInput &operator=(TextInput &&) = default;
+
+public:
+  void run(Writer &writer) override {
+    bool interrupted = false;
+    Session *session = writer.session();
+    if (session && session->replaying()) {
+      value_ = session->next(name());
+    } else {
+      std::optional<RawMode> raw_mode;
+      if (is_interactive(writer.fd())) {
+        raw_mode.emplace();
+      }
+      if (raw_mode && raw_mode->active()) {
+        interrupted = !edit(writer);
+      } else {
+        writer.out(prompt_);
+        std::getline(std::cin, value_);
+      }
+    }
+    if (interrupted) {
+      std::raise(SIGINT);
+    }
+    if (session) {
+      session->record(name(), value_);
+    }
+    auto span = writer.trace("TextInput callback");
+    callback_(value_);
+  }
+  const char *name() const override { return "TextInput"; }
+
+private:
+  // Returns false if the input was interrupted with ctrl-c.
+  bool edit(Writer &writer) {
+    KeyReader reader;
+    std::vector<KeyEvent> events;
+    std::string inserted;
+    while (true) {
+      render(writer, true);
+      if (!reader.read(events)) {
+        break;
+      }
+      for (const KeyEvent &event : events) {
+        if (event.key == Key::CHAR) {
+          inserted += event.ch;
+          continue;
+        }
+        insert(inserted);
+        switch (event.key) {
+        case Key::ENTER:
+          render(writer, false);
+          return true;
+        case Key::INTERRUPT:
+          render(writer, false);
+          return false;
+        case Key::END_OF_FILE:
+          if (value_.empty()) {
+            render(writer, false);
+            return true;
+          }
+          erase(cursor_, next(cursor_));
+          break;
+        case Key::BACKSPACE:
+          erase(prev(cursor_), cursor_);
+          break;
+        case Key::DELETE:
+          erase(cursor_, next(cursor_));
+          break;
+        case Key::LEFT:
+          cursor_ = prev(cursor_);
+          break;
+        case Key::RIGHT:
+          cursor_ = next(cursor_);
+          break;
+        case Key::HOME:
+          cursor_ = 0;
+          break;
+        case Key::END:
+          cursor_ = value_.size();
+          break;
+        case Key::CONTROL:
+          control(event.ch);
+          break;
+        default:
+          break;
+        }
+      }
+      insert(inserted);
+    }
+    render(writer, false);
+    return true;
+  }
+  void control(char ch) {
+    switch (ch) {
+    case 'A':
+      cursor_ = 0;
+      break;
+    case 'E':
+      cursor_ = value_.size();
+      break;
+    case 'K':
+      erase(cursor_, value_.size());
+      break;
+    case 'U':
+      erase(0, cursor_);
+      break;
+    case 'W': {
+      std::size_t begin = cursor_;
+      while (begin > 0 && value_[begin - 1] == ' ') {
+        begin--;
+      }
+      while (begin > 0 && value_[begin - 1] != ' ') {
+        begin--;
+      }
+      erase(begin, cursor_);
+      break;
+    }
+    }
+  }
+
+  /* Editing */
+  void insert(std::string &text) {
+    if (!text.empty()) {
+      value_.insert(cursor_, text);
+      cursor_ += text.size();
+      text.clear();
+    }
+  }
+  void erase(std::size_t begin, std::size_t end) {
+    value_.erase(begin, end - begin);
+    cursor_ = begin;
+  }
+  // utf-8 aware cursor steps
+  std::size_t prev(std::size_t index) const {
+    while (index > 0 && is_continuation(value_[--index])) {
+    }
+    return index;
+  }
+  std::size_t next(std::size_t index) const {
+    if (index < value_.size()) {
+      index++;
+    }
+    while (index < value_.size() && is_continuation(value_[index])) {
+      index++;
+    }
+    return index;
+  }
+  static bool is_continuation(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+  }
+  std::size_t cells(std::size_t begin, std::size_t end) const {
+    std::size_t count = 0;
+    for (std::size_t i = begin; i < end; i++) {
+      count += !is_continuation(value_[i]);
+    }
+    return count;
+  }
+
+  /* Rendering */
+  // Draws the part of the value around the cursor that fits on one row. The
+  // writer's retained block sends only what changed since the last draw.
+  void render(Writer &writer, bool editing) {
+    std::size_t width = writer.width();
+    std::size_t room =
+        width > prompt_.size() + 1 ? width - prompt_.size() - 1 : 1;
+    if (cursor_ < view_) {
+      view_ = cursor_;
+    }
+    while (cells(view_, cursor_) >= room) {
+      view_ = next(view_);
+    }
+    std::size_t end = view_;
+    for (std::size_t shown = 0; end < value_.size() && shown < room;
+         shown++) {
+      end = next(end);
+    }
+    line_.assign(prompt_);
+    line_.append(value_, view_, end - view_);
+    writer.begin_frame();
+    if (editing) {
+      writer.reset_cursor();
+    }
+    writer.out(line_);
+    if (editing) {
+      writer.move_column(prompt_.size() + cells(view_, cursor_) + 1);
+    }
+    writer.end_frame();
+  }
+
+private:
+  std::string prompt_;
+  str_callback_t callback_;
+  std::string value_;
+  std::size_t cursor_ = 0;
+  std::size_t view_ = 0;
+  std::string line_;
+};
+
+} // namespace quikcli
+
+#endif // QC_INPUT_H_
@@ -0,0 +1,139 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_LOG_H_
+#define QC_LOG_H_
+
+#include <atomic>
+#include <string>
+#include <utility>
+
+namespace quikcli {
+
+// A lock-free queue of log lines with many producers and one consumer.
+// Producers push onto a list head with a compare-and-swap; the consumer takes
+// the whole list with one exchange and reverses it, so lines come out in the
+// order they were pushed and no entry is ever popped from under a producer.
+// Drained entries are recycled rather than freed, so push() only allocates
+// while more lines are queued at once than ever before; the line itself is
+// the caller's.
+class LogQueue {
+private:
+  struct Entry {
+    std::string line;
+    Entry *next;
+  };
+
+public:
+  /* Constructors & Destructors - No Copy No Move */
+  LogQueue() = default;
+  ~LogQueue() { drain([](std::string &) {}); }
+
+  LogQueue(LogQueue &) = delete;
+  LogQueue &operator=(LogQueue &) = delete;
+  LogQueue(LogQueue &&) = delete;
+  LogQueue &operator=(LogQueue &&) = delete;
+
+public:
+  // Safe to call from any thread.
+  void push(std::string line) {
+    Entry *entry = acquire();
+    entry->line = std::move(line);
+    entry->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(entry->next, entry,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+  }
+  bool empty() const {
+    return head_.load(std::memory_order_relaxed) == nullptr;
+  }
+  // Hands each queued line to consume, oldest first. Only one thread may
+  // drain at a time.
+  template <class Consume> bool drain(Consume &&consume) {
+    Entry *entry = head_.exchange(nullptr, std::memory_order_acquire);
+    if (!entry) {
+      return false;
+    }
+    Entry *newest = entry;
+    Entry *oldest = nullptr;
+    while (entry) {
+      Entry *next = entry->next;
+      entry->next = oldest;
+      oldest = entry;
+      entry = next;
+    }
+    for (entry = oldest; entry; entry = entry->next) {
+      consume(entry->line);
+      std::string{}.swap(entry->line);
+    }
+    recycle(oldest, newest);
+    return true;
+  }
+
+private:
+  /* Entry Recycling */
+  // A producer takes the whole free list at once into a cache of its own, so
+  // that, as with the queue, no entry is popped from under another thread.
+  struct Cache {
+    Entry *entries = nullptr;
+
+    ~Cache() {
+      while (entries) {
+        delete std::exchange(entries, entries->next);
+      }
+    }
+  };
+
+  static Entry *acquire() {
+    thread_local Cache cache;
+    if (!cache.entries) {
+      cache.entries = free_.exchange(nullptr, std::memory_order_acquire);
+    }
+    if (!cache.entries) {
+      return new Entry{};
+    }
+    return std::exchange(cache.entries, cache.entries->next);
+  }
+  static void recycle(Entry *first, Entry *last) {
+    last->next = free_.load(std::memory_order_relaxed);
+    while (!free_.compare_exchange_weak(last->next, first,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+  }
+
+  // shared by every queue, since entries do not belong to any one of them
+  static inline std::atomic<Entry *> free_ = nullptr;
+
+private:
+  std::atomic<Entry *> head_ = nullptr;
+};
+
+} // namespace quikcli
+
+#endif // QC_LOG_H_
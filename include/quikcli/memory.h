@@ -0,0 +1,116 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_MEMORY_H_
+#define QC_MEMORY_H_
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+namespace quikcli {
+
+// Counts what is allocated through it before passing the request upstream,
+// e.g. to check how often parsing a command line allocates:
+//
+//   std::pmr::monotonic_buffer_resource arena{4096};
+//   quikcli::CountingResource counter{&arena};
+//   quikcli::QuikCli cli{"prog", "0.0.1", &counter};
+class CountingResource : public std::pmr::memory_resource {
+public:
+  explicit CountingResource(
+      std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : upstream_{upstream} {}
+
+public:
+  /* Getters */
+  uint64_t allocations() const { return allocations_; }
+  uint64_t deallocations() const { return deallocations_; }
+  uint64_t bytes() const { return bytes_; }
+  void reset() { allocations_ = deallocations_ = bytes_ = 0; }
+
+private:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    allocations_++;
+    bytes_ += bytes;
+    return upstream_->allocate(bytes, alignment);
+  }
+  void do_deallocate(void *p, std::size_t bytes,
+                     std::size_t alignment) override {
+    deallocations_++;
+    upstream_->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override {
+    return this == &other;
+  }
+
+private:
+  std::pmr::memory_resource *upstream_;
+  uint64_t allocations_ = 0;
+  uint64_t deallocations_ = 0;
+  uint64_t bytes_ = 0;
+};
+
+// Deletes an object through the base class it is held by, returning it to the
+// memory resource it was made from, or with delete if it was made with new.
+template <class Base> class ResourceDeleter {
+public:
+  ResourceDeleter() = default;
+  ResourceDeleter(std::default_delete<Base>) {}
+
+  template <class T, class... ArgsT>
+  static std::unique_ptr<Base, ResourceDeleter>
+  make(std::pmr::memory_resource *resource, ArgsT &&...args) {
+    std::pmr::polymorphic_allocator<> allocator{resource};
+    T *object = allocator.new_object<T>(std::forward<ArgsT>(args)...);
+    ResourceDeleter deleter;
+    deleter.resource_ = resource;
+    deleter.destroy_ = [](Base *base, std::pmr::memory_resource *resource) {
+      std::pmr::polymorphic_allocator<> allocator{resource};
+      allocator.delete_object(static_cast<T *>(base));
+    };
+    return std::unique_ptr<Base, ResourceDeleter>{object, deleter};
+  }
+
+public:
+  void operator()(Base *object) const {
+    if (destroy_) {
+      destroy_(object, resource_);
+    } else {
+      delete object;
+    }
+  }
+
+private:
+  std::pmr::memory_resource *resource_ = nullptr;
+  void (*destroy_)(Base *, std::pmr::memory_resource *) = nullptr;
+};
+
+} // namespace quikcli
+
+#endif // QC_MEMORY_H_
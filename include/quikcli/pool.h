@@ -0,0 +1,245 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_POOL_H_
+#define QC_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace quikcli {
+
+// Runs a graph of jobs across a few threads, the calling thread included.
+// Each thread keeps a deque of ready jobs, working from its back and stealing
+// from the front of the others' once it runs dry. A job becomes ready once
+// every job it waits on has returned.
+class WorkPool {
+public:
+  // to waits on from
+  struct Edge {
+    uint32_t from;
+    uint32_t to;
+  };
+
+  /* Constructors & Destructors - No Copy No Move */
+  explicit WorkPool(
+      std::size_t threads,
+      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+      : threads_{std::max<std::size_t>(threads, 1)}, resource_{resource} {}
+
+  WorkPool(WorkPool &) = delete;
+  WorkPool &operator=(WorkPool &) = delete;
+  WorkPool(WorkPool &&) = delete;
+  WorkPool &operator=(WorkPool &&) = delete;
+
+public:
+  // Calls job(i) once for each i < count, returning after all have returned.
+  // job must not throw. Threads are started for the run and joined before it
+  // returns; none are started for a single thread or job. Returns false
+  // without calling anything if the edges form a cycle.
+  template <class Job>
+  bool run(std::size_t count, std::span<const Edge> edges, Job &&job) {
+    Graph graph{count, edges, resource_};
+    if (!graph.acyclic()) {
+      return false;
+    }
+    std::size_t threads = std::min(threads_, count);
+    if (threads == 0) {
+      return true;
+    }
+    Run run{graph, threads, resource_};
+    // reversed so the calling thread takes them in order
+    for (std::size_t i = count; i-- > 0;) {
+      if (graph.waiting[i] == 0) {
+        run.push(0, i);
+      }
+    }
+    std::pmr::vector<std::thread> workers{resource_};
+    workers.reserve(threads - 1);
+    for (std::size_t w = 1; w < threads; w++) {
+      workers.emplace_back([&, w] { run.work(w, job); });
+    }
+    run.work(0, job);
+    for (std::thread &worker : workers) {
+      worker.join();
+    }
+    return true;
+  }
+
+private:
+  // Successors of each job in compressed rows, and the count each waits on.
+  struct Graph {
+    Graph(std::size_t count, std::span<const Edge> edges,
+          std::pmr::memory_resource *resource)
+        : count{count}, begin(count + 1, 0, resource),
+          next(edges.size(), 0, resource), waiting(count, 0, resource) {
+      for (Edge edge : edges) {
+        begin[edge.from + 1]++;
+        waiting[edge.to]++;
+      }
+      for (std::size_t i = 0; i < count; i++) {
+        begin[i + 1] += begin[i];
+      }
+      std::pmr::vector<uint32_t> filled{begin.begin(), begin.end() - 1,
+                                        resource};
+      for (Edge edge : edges) {
+        next[filled[edge.from]++] = edge.to;
+      }
+    }
+
+    std::span<const uint32_t> successors(std::size_t job) const {
+      return std::span{next}.subspan(begin[job], begin[job + 1] - begin[job]);
+    }
+    // Kahn's algorithm, run ahead of time so a cycle cannot stall the pool.
+    bool acyclic() const {
+      std::pmr::vector<uint32_t> left{waiting, waiting.get_allocator()};
+      std::pmr::vector<uint32_t> ready{waiting.get_allocator()};
+      for (std::size_t i = 0; i < count; i++) {
+        if (left[i] == 0) {
+          ready.push_back(i);
+        }
+      }
+      std::size_t visited = 0;
+      while (!ready.empty()) {
+        uint32_t job = ready.back();
+        ready.pop_back();
+        visited++;
+        for (uint32_t successor : successors(job)) {
+          if (--left[successor] == 0) {
+            ready.push_back(successor);
+          }
+        }
+      }
+      return visited == count;
+    }
+
+    std::size_t count;
+    std::pmr::vector<uint32_t> begin;
+    std::pmr::vector<uint32_t> next;
+    std::pmr::vector<uint32_t> waiting;
+  };
+
+  // Each job is pushed once, so a queue never holds more than count jobs and
+  // its buffer is used without wrapping: the owner pops at tail, thieves at
+  // head.
+  struct alignas(64) Queue {
+    std::mutex mutex;
+    uint32_t head = 0;
+    uint32_t tail = 0;
+  };
+
+  struct Run {
+    Run(const Graph &graph, std::size_t threads,
+        std::pmr::memory_resource *resource)
+        : graph{graph}, queues(threads, resource),
+          jobs(threads * graph.count, 0, resource),
+          waiting(graph.count, resource), remaining{graph.count} {
+      for (std::size_t i = 0; i < graph.count; i++) {
+        waiting[i].store(graph.waiting[i], std::memory_order_relaxed);
+      }
+    }
+
+    template <class Job> void work(std::size_t self, Job &job) {
+      while (remaining.load(std::memory_order_acquire) > 0) {
+        std::optional<uint32_t> ready = take(self);
+        if (!ready) {
+          // jobs pushed after this read bump the epoch, so the wait below
+          // cannot miss them
+          uint64_t seen = epoch.load(std::memory_order_acquire);
+          ready = take(self);
+          if (!ready) {
+            if (remaining.load(std::memory_order_acquire) > 0) {
+              epoch.wait(seen, std::memory_order_acquire);
+            }
+            continue;
+          }
+        }
+        job(*ready);
+        for (uint32_t successor : graph.successors(*ready)) {
+          if (waiting[successor].fetch_sub(1, std::memory_order_acq_rel) ==
+              1) {
+            push(self, successor);
+          }
+        }
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          wake();
+        }
+      }
+    }
+    void push(std::size_t self, uint32_t job) {
+      {
+        std::lock_guard lock{queues[self].mutex};
+        jobs[self * graph.count + queues[self].tail++] = job;
+      }
+      wake();
+    }
+    std::optional<uint32_t> take(std::size_t self) {
+      {
+        Queue &own = queues[self];
+        std::lock_guard lock{own.mutex};
+        if (own.tail > own.head) {
+          return jobs[self * graph.count + --own.tail];
+        }
+      }
+      for (std::size_t i = 1; i < queues.size(); i++) {
+        std::size_t victim = (self + i) % queues.size();
+        Queue &other = queues[victim];
+        std::lock_guard lock{other.mutex};
+        if (other.tail > other.head) {
+          return jobs[victim * graph.count + other.head++];
+        }
+      }
+      return std::nullopt;
+    }
+    void wake() {
+      epoch.fetch_add(1, std::memory_order_release);
+      epoch.notify_all();
+    }
+
+    const Graph &graph;
+    std::pmr::vector<Queue> queues;
+    std::pmr::vector<uint32_t> jobs;
+    std::pmr::vector<std::atomic<uint32_t>> waiting;
+    std::atomic<std::size_t> remaining;
+    std::atomic<uint64_t> epoch = 0;
+  };
+
+private:
+  std::size_t threads_;
+  std::pmr::memory_resource *resource_;
+};
+
+} // namespace quikcli
+
+#endif // QC_POOL_H_
@@ -28,148 +28,339 @@
 #ifndef QC_QUIKCLI_H_
 #define QC_QUIKCLI_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <deque>
+#include <exception>
+#include <functional>
 #include <iomanip>
 #include <ios>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <span>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
 #include "constants.h"
 #include "exception.h"
+#include "quikcli/async.h"
+#include "quikcli/completion.h"
 #include "quikcli/component.h"
 #include "quikcli/flag.h"
+#include "quikcli/input.h"
+#include "quikcli/memory.h"
+#include "quikcli/pool.h"
+#include "quikcli/response.h"
+#include "quikcli/result.h"
+#include "quikcli/schema.h"
+#include "quikcli/select.h"
+#include "quikcli/stream.h"
+#include "quikcli/trace.h"
 #include "quikcli/writer.h"
 
 namespace quikcli {
 
+// Registers a subcommand's flags and components on the QuikCli built for it.
+using subcommand_factory_t = InplaceFunction<void(QuikCli &)>;
+
 class QuikCli {
+  // Only make_subcommand() can name it.
+  struct SubcommandTag {};
+
 public:
-  /* Constructors & Destructors - No Copy Default Move */
-  QuikCli(std::string name, std::string version)
-      : name_{name}, version_{version} {
+  /* Constructors & Destructors - No Copy No Move */
+  // Flags, parsed arguments, subcommands and components emplaced with
+  // emplace_component() are all allocated from resource, so a single arena
+  // can back a whole run.
+  QuikCli(std::string_view name, std::string_view version,
+          std::pmr::memory_resource *resource =
+              std::pmr::get_default_resource())
+      : QuikCli(SubcommandTag{}, name, version, resource) {
+    add_flag(DefaultFlagNames::completion, DefaultFlagDescription::completion,
+             [&](flag_params_t params) {
+               default_completion_func(*this, params[0]);
+             })
+        .set_param_count(1);
+  }
+  // A subcommand has no --completion of its own; the top-level command's
+  // script completes it.
+  QuikCli(SubcommandTag, std::string_view name, std::string_view version,
+          std::pmr::memory_resource *resource)
+      : resource_{resource}, name_{name, resource}, version_{version,
+                                                             resource} {
+    writer.set_tracer(&tracer_);
     add_flag(DefaultFlagNames::version, DefaultFlagDescription::version,
-             [&](std::vector<std::string> &) { default_version_func(*this); })
+             [&](flag_params_t) { default_version_func(*this); })
         .set_alias(DefaultFlagAliases::version)
         .set_param_count(0);
     add_flag(DefaultFlagNames::help, DefaultFlagDescription::help,
-             [&](std::vector<std::string> &) { default_help_func(*this); })
+             [&](flag_params_t) { default_help_func(*this); })
         .set_alias(DefaultFlagAliases::help)
         .set_param_count(0);
   }
 
+  // Flags, the default flags' callbacks and the writer all point back into
+  // the object, so it stays put.
   QuikCli(QuikCli &) = delete;
   QuikCli &operator=(QuikCli &) = delete;
-  QuikCli(QuikCli &&) = default;
-  QuikCli &operator=(QuikCli &&) = default;
+  QuikCli(QuikCli &&) = delete;
+  QuikCli &operator=(QuikCli &&) = delete;
 
   ~QuikCli() = default;
 
 public:
   /* Getters & Setters */
-  std::string name() const { return name_; }
-  void set_name(std::string name) { name_ = name; }
-  std::string version() const { return version_; }
-  void set_version(std::string version) { version_ = version; }
+  std::string name() const { return std::string{name_}; }
+  void set_name(std::string_view name) { name_ = name; }
+  std::string version() const { return std::string{version_}; }
+  void set_version(std::string_view version) { version_ = version; }
+  std::pmr::memory_resource *resource() const { return resource_; }
+  Tracer &tracer() { return tracer_; }
+  // How many upcoming AsyncComponents have prepare() started ahead of their
+  // turn. The component being run is always prepared.
+  void set_prefetch_depth(std::size_t depth) { prefetch_depth_ = depth; }
+  // Deferred flag callbacks run on up to threads threads, the calling one
+  // included, in an order that respects Flag::depends_on; with more than one,
+  // callbacks not ordered by a dependency must be safe to run concurrently.
+  // Immediately parsed and streamed flags still run during parsing.
+  void set_parse_threads(std::size_t threads) { parse_threads_ = threads; }
+  // Components are drawn by a thread of the writer's own at frame_rate frames
+  // a second, so that a slow terminal never stalls them; 0 draws on the
+  // calling thread. Applies to subcommands too, including one parse_flags has
+  // already built.
+  void set_render_rate(uint32_t frame_rate) {
+    render_rate_ = frame_rate;
+    writer.set_render_rate(frame_rate);
+    if (subcommand_) {
+      subcommand_->set_render_rate(frame_rate);
+    }
+  }
+
+  /* Sessions */
+  // Once run() returns, saves what each TextInput and Select produced to path,
+  // subcommands' included.
+  void record_session(std::string path) {
+    set_session(std::move(path), Session::Mode::RECORD);
+  }
+  // Runs as a batch: TextInputs and Selects take the values recorded to path
+  // in turn, nothing is drawn, and loaders wait only on their work.
+  void replay_session(std::string path) {
+    writer.set_headless(true);
+    set_session(std::move(path), Session::Mode::REPLAY);
+  }
 
   /* Configurations */
-  Flag &add_flag(std::string name, std::string description) {
+  Flag &add_flag(std::string_view name, std::string_view description) {
     check_dup_flag(name);
-    flags_.emplace(name, Flag{name, description});
-    return flags_.at(name);
+    return register_flag(name, description);
   }
-  Flag &add_flag(std::string name, std::string description,
+  Flag &add_flag(std::string_view name, std::string_view description,
                  flag_callback_t callback) {
     check_dup_flag(name);
-    flags_.emplace(name, Flag{name, description, std::move(callback)});
-    return flags_.at(name);
+    return register_flag(name, description, std::move(callback));
   }
   template <class... ParamsT>
     requires(has_istream_operator<ParamsT> && ...)
-  Flag &add_flag(std::string name, std::string description,
+  Flag &add_flag(std::string_view name, std::string_view description,
                  ParamsT &...params) {
     check_dup_flag(name);
-    flags_.emplace(name, Flag{name, description, params...});
-    return flags_.at(name);
+    return register_flag(name, description, params...);
   }
 
+  // The factory only runs if the subcommand is selected, by naming it after
+  // any of this command's own flags, e.g. prog --verbose ask --all. Those flags
+  // are set and their callbacks run first; the arguments after the name are
+  // then parsed by the subcommand. A word that the current flag has no room
+  // for is taken as the name, and so is a subcommand's name after a variadic
+  // flag.
+  void add_subcommand(std::string_view name, std::string_view description,
+                      subcommand_factory_t factory) {
+    if (subcommands_.contains(name)) {
+      throw Exception(ExceptionType::CONFIGURATION,
+                      "subcommand " + std::string{name} +
+                          " has been repeated.");
+    }
+    subcommands_.emplace(
+        std::piecewise_construct, std::forward_as_tuple(name),
+        std::forward_as_tuple(description, std::move(factory)));
+  }
+  // The subcommand selected by parse_flags, if any.
+  QuikCli *subcommand() { return subcommand_.get(); }
+
   /* Run-Time Functions */
+  // Parameters are handed to flags as views into argv, which must outlive the
+  // flag callbacks. Besides --name and -a, --name=value and chained aliases
+  // (-abc, where only the last alias takes the following parameters) are
+  // accepted. An argument @path is replaced by the arguments in the response
+  // file at path, which may name further response files.
   void parse_flags(int argc, char *argv[]) {
-    std::unordered_map<char, std::string> aliases;
-    for (const auto &[_, flag] : flags_) {
-      if (flag.alias().has_value()) {
-        aliases.emplace(flag.alias().value(), flag.name());
-      }
-    }
     try {
-      std::vector<std::string> params;
-      std::vector<Flag *> set_flags;
-      Flag *current_flag = nullptr;
-      for (int i = 1; i < argc; i++) {
-        std::string argstr = argv[i];
-        if (argstr.length() >= 2 && argstr[0] == '-') {
-          Flag *next_flag;
-          if (argstr[1] == '-') {
-            std::string flag_name = argstr.substr(2);
-            if (!flags_.contains(flag_name)) {
-              throw Exception(ExceptionType::PARSER,
-                              argstr + " is not a valid flag.");
-            }
-            next_flag = &flags_.at(flag_name);
-          } else {
-            // TODO: handle chained aliases (i.e. -abc)
-            if (argstr.length() != 2 || !aliases.contains(argstr[1])) {
-              throw Exception(ExceptionType::PARSER,
-                              argstr + " is not a valid flag.");
-            }
-            next_flag = &flags_.at(aliases.at(argstr[1]));
-          }
-          if (next_flag->is_set()) {
-            throw Exception(ExceptionType::PARSER,
-                            argstr + " has already been set.");
-          }
-          if (current_flag) {
-            current_flag->set(params);
-            params.clear();
-            set_flags.emplace_back(current_flag);
-          }
-          current_flag = next_flag;
-        } else {
-          if (!current_flag) {
-            throw Exception(ExceptionType::PARSER,
-                            "Expected flag but got \"" + argstr + "\".");
-          }
-          params.emplace_back(std::move(argstr));
-        }
-      }
-      if (current_flag) {
-        current_flag->set(params);
-        set_flags.emplace_back(current_flag);
-      }
-      for (auto flag : set_flags) {
-        flag->parse();
+      if (ParseResult<> result = try_parse_flags(argc, argv); !result) {
+        cleanup(result.error().exception());
+        exit();
       }
     } catch (Exception &exception) {
       cleanup(exception);
       exit();
     }
   }
+  // The default --help and --version are honoured unless the schema claims
+  // their names; --help lists the schema's flags too.
+  template <std::size_t N>
+  SchemaArgs<N> parse_flags(const FlagSchema<N> &schema, int argc,
+                            char *argv[]) {
+    ParseResult<SchemaArgs<N>> result = schema.try_parse(argc, argv);
+    if (result) {
+      return std::move(*result);
+    }
+    const ParseError &error = result.error();
+    if (error.code == ParseErrorCode::UNKNOWN_FLAG &&
+        names_flag(error.arg, DefaultFlagNames::help,
+                   DefaultFlagAliases::help)) {
+      default_help_func(*this, schema.specs());
+    } else if (error.code == ParseErrorCode::UNKNOWN_FLAG &&
+               names_flag(error.arg, DefaultFlagNames::version,
+                          DefaultFlagAliases::version)) {
+      default_version_func(*this);
+    } else {
+      cleanup(error.exception());
+      exit();
+    }
+    return SchemaArgs<N>{schema};
+  }
+  // Like parse_flags, but a rejected command line is returned as a ParseError
+  // instead of being reported, and nothing is thrown on the way. Exceptions
+  // thrown by flag callbacks themselves still propagate.
+  ParseResult<> try_parse_flags(int argc, char *argv[]) {
+    args_.clear();
+    positions_.clear();
+    args_.reserve(argc);
+    positions_.reserve(argc);
+    response_files_.clear();
+    ParseState state{resource_, false};
+    // each flag can only be set once
+    state.set_flags.reserve(flags_.size());
+    if (!parse_argv(state, argc, argv)) {
+      return *state.error;
+    }
+    // response files may have moved args_ since the flags were set
+    for (auto [flag, begin, end] : state.set_flags) {
+      if (!flag->is_streamed()) {
+        flag->params_ = flag_params_t{args_}.subspan(begin, end - begin);
+      }
+    }
+    ParseResult<> result = run_deferred(state);
+    if (!result || !is_active_ || state.command == 0) {
+      return result;
+    }
+    int command = state.command;
+    auto subcommand = subcommands_.find(std::string_view{argv[command]});
+    if (subcommand == subcommands_.end()) {
+      return ParseError{ParseErrorCode::UNKNOWN_COMMAND, command,
+                        argv[command]};
+    }
+    subcommand_ = make_subcommand(*subcommand);
+    result = subcommand_->try_parse_flags(argc - command, argv + command);
+    if (!subcommand_->is_active_) {
+      exit();
+    }
+    return shift(std::move(result), command);
+  }
+  template <std::size_t N>
+  ParseResult<SchemaArgs<N>> try_parse_flags(const FlagSchema<N> &schema,
+                                             int argc, char *argv[]) {
+    return schema.try_parse(argc, argv);
+  }
+  // Checks a command line against the registered flags without setting them
+  // or calling any callbacks, e.g. to vet stored command lines in bulk. Only
+  // its form is checked: parameters are counted but not converted. A named
+  // subcommand is built to check the rest, and kept for later checks.
+  ParseResult<> validate_flags(int argc, char *argv[]) {
+    validated_files_.clear();
+    seen_.assign(flags_.size(), false);
+    ParseState state{resource_, true};
+    if (!parse_argv(state, argc, argv)) {
+      return *state.error;
+    }
+    int command = state.command;
+    if (command == 0) {
+      return {};
+    }
+    auto validator = validators_.find(std::string_view{argv[command]});
+    if (validator == validators_.end()) {
+      auto subcommand = subcommands_.find(std::string_view{argv[command]});
+      if (subcommand == subcommands_.end()) {
+        return ParseError{ParseErrorCode::UNKNOWN_COMMAND, command,
+                          argv[command]};
+      }
+      validator =
+          validators_.emplace(subcommand->first, make_subcommand(*subcommand))
+              .first;
+    }
+    return shift(
+        validator->second->validate_flags(argc - command, argv + command),
+        command);
+  }
 
   /* Runtime */
   void push_component(std::unique_ptr<Component> component) {
     components.emplace_back(std::move(component));
   }
+  // Makes the component in the QuikCli's memory resource.
+  template <class ComponentT, class... ArgsT>
+  ComponentT &emplace_component(ArgsT &&...args) {
+    component_ptr_t &component = components.emplace_back(
+        ResourceDeleter<Component>::make<ComponentT>(
+            resource_, std::forward<ArgsT>(args)...));
+    return static_cast<ComponentT &>(*component);
+  }
+  // Runs the components, then those of the selected subcommand.
   void run() {
     while (!components.empty() && is_active_) {
-      components.front()->run(writer);
+      prefetch();
+      {
+        Component &component = *components.front();
+        Tracer::Span span = tracer_.span(component.name(), "component");
+        // the stats are behind a lock with a render thread, so untraced runs
+        // leave them alone
+        WriterStats before = span.active() ? writer.total_stats()
+                                           : WriterStats{};
+        writer.begin_component(component.name());
+        if (auto async = dynamic_cast<AsyncComponent *>(&component)) {
+          async->run(writer, scheduler_);
+        } else {
+          component.run(writer);
+        }
+        writer.end_component(component.name());
+        if (span.active()) {
+          WriterStats after = writer.total_stats();
+          span.set_output(after.bytes - before.bytes,
+                          after.frames - before.frames);
+        }
+      }
       components.pop_front();
     }
+    if (subcommand_ && is_active_) {
+      subcommand_->run();
+    }
+    // a run cut short would overwrite a good recording with part of one
+    if (session_ && session_->recording() && completed()) {
+      session_->save();
+    }
   }
   void exit() { is_active_ = false; }
+  // False once exit() was called, e.g. by --help, --version or a rejected
+  // command line.
+  bool is_active() const { return is_active_; }
+  // Prints line above whatever is being drawn, at its next frame, including a
+  // subcommand's output. Safe to call from any thread, and never blocks on the
+  // terminal.
+  void log(std::string line) { writer.log(std::move(line)); }
 
 private:
   /* Exception Handling */
@@ -182,44 +373,498 @@ private:
     std::cout << cli.name() << " version " << cli.version() << std::endl;
     cli.exit();
   }
-  static void default_help_func(QuikCli &cli) {
+  // With a schema, its flags are listed in place of the registered ones, of
+  // which only --help and --version apply.
+  static void default_help_func(
+      QuikCli &cli,
+      std::optional<std::span<const FlagSpec>> schema = std::nullopt) {
     constexpr int col_width = 18;
     constexpr char tab[] = "  ";
     std::cout << cli.name() << " version " << cli.version() << std::endl;
     std::cout << std::endl;
+    if (!cli.subcommands_.empty()) {
+      std::cout << "Commands:" << std::endl;
+      for (const auto &[name, subcommand] : cli.subcommands_) {
+        std::cout << tab << std::left << std::setw(col_width) << name;
+        if (name.length() > col_width) {
+          std::cout << std::endl << std::setw(col_width) << "";
+        }
+        std::cout << tab << subcommand.description << std::endl;
+      }
+      std::cout << std::endl;
+    }
     std::cout << "Options:" << std::endl;
-    for (const auto &[_, flag] : cli.flags_) {
-      std::string message = "--" + flag.name();
-      if (flag.alias().has_value()) {
+    auto print_option = [&](std::string_view name, std::optional<char> alias,
+                            std::string_view description) {
+      std::string message = "--" + std::string{name};
+      if (alias.has_value()) {
         message += ", -";
-        message += flag.alias().value();
+        message += alias.value();
       }
       std::cout << tab << std::left << std::setw(col_width) << message;
       if (message.length() > col_width) {
         std::cout << std::endl << std::setw(col_width) << "";
       }
-      std::cout << tab << flag.description() << std::endl;
+      std::cout << tab << description << std::endl;
+    };
+    if (schema.has_value()) {
+      for (const FlagSpec &spec : *schema) {
+        std::optional<char> alias;
+        if (spec.alias != '\0') {
+          alias = spec.alias;
+        }
+        print_option(spec.name, alias, spec.description);
+      }
+    }
+    for (const auto &[name, flag] : cli.flags_) {
+      if (schema.has_value() && name != DefaultFlagNames::help &&
+          name != DefaultFlagNames::version) {
+        continue;
+      }
+      print_option(flag.name(), flag.alias(), flag.description());
     }
     cli.exit();
   }
+  static void default_completion_func(QuikCli &cli, std::string_view shell) {
+    CompletionTable table{cli.name(), {}, {}};
+    cli.describe_completion(table.flags, table.commands);
+    if (!write_completion(std::cout, shell, table)) {
+      throw Exception(ExceptionType::PARSER,
+                      "unsupported shell " + std::string{shell} +
+                          ", expected bash, zsh or fish.");
+    }
+    cli.exit();
+  }
+
+  // Subcommands are built to find their flags, so their factories run, though
+  // nothing they register is run.
+  void describe_completion(std::vector<CompletionTable::Flag> &flags,
+                           std::vector<CompletionTable::Command> &commands) {
+    for (const auto &[_, flag] : flags_) {
+      flags.push_back({flag.name(), flag.alias(), flag.description(),
+                       flag.param_count()});
+      if (flag.name() == DefaultFlagNames::completion) {
+        flags.back().values = std::string{CompletionShells::bash} + " " +
+                              CompletionShells::zsh + " " +
+                              CompletionShells::fish;
+      }
+    }
+    for (auto &subcommand : subcommands_) {
+      CompletionTable::Command &command = commands.emplace_back(
+          std::string{subcommand.first},
+          std::string{subcommand.second.description});
+      subcommand_ptr_t cli = make_subcommand(subcommand);
+      cli->describe_completion(command.flags, command.commands);
+    }
+  }
+
+  /* Parsing */
+  // Tracks a pass over the command line. While validating, flags are only
+  // marked in seen_ and their parameters are counted rather than stored.
+  struct ParseState {
+    struct SetFlag {
+      Flag *flag;
+      std::size_t begin;
+      std::size_t end;
+    };
+    ParseState(std::pmr::memory_resource *resource, bool validate)
+        : validate{validate}, set_flags{resource} {}
+
+    bool validate;
+    std::optional<ParseError> error;
+    int position = 0;
+    std::pmr::vector<SetFlag> set_flags;
+    Flag *current_flag = nullptr;
+    std::string_view flag_arg;
+    int flag_position = 0;
+    std::size_t params_begin = 0;
+    uint32_t param_count = 0;
+    // index into argv of the subcommand's name, if one was named
+    int command = 0;
+  };
+
+  // The helpers below return false once state.error has been set.
+  bool parse_argv(ParseState &state, int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+      state.position = i;
+      if (names_subcommand(state, argv[i])) {
+        state.command = i;
+        break;
+      }
+      if (!parse_arg(state, argv[i], nullptr, 0)) {
+        return false;
+      }
+    }
+    return close_flag(state);
+  }
+  // file is the response file arg was read from, if any.
+  bool parse_arg(ParseState &state, std::string_view arg, ResponseFile *file,
+                 uint32_t depth) {
+    if (arg.length() >= 2 && arg[0] == ResponseFileDefaults::prefix) {
+      return expand(state, arg.substr(1), depth + 1);
+    }
+    if (arg.length() >= 2 && arg[0] == '-') {
+      if (file) {
+        // kept mapped for a ParseError that names it
+        file->pin(arg);
+      }
+      if (arg[1] == '-') {
+        std::string_view name = arg.substr(2);
+        std::size_t equals = name.find('=');
+        auto flag = flags_.find(name.substr(0, equals));
+        if (flag == flags_.end()) {
+          return fail(state, ParseErrorCode::UNKNOWN_FLAG, arg);
+        }
+        if (!next_flag(state, flag->second, arg)) {
+          return false;
+        }
+        return equals == std::string_view::npos ||
+               push_param(state, name.substr(equals + 1), file);
+      }
+      for (char alias : arg.substr(1)) {
+        if (alias <= 0 || !aliases_[alias]) {
+          return fail(state, ParseErrorCode::UNKNOWN_FLAG, arg);
+        }
+        if (!next_flag(state, *aliases_[alias], arg)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    if (!state.current_flag) {
+      return fail(state, ParseErrorCode::UNEXPECTED_ARGUMENT, arg);
+    }
+    return push_param(state, arg, file);
+  }
+  bool expand(ParseState &state, std::string_view path, uint32_t depth) {
+    if (depth > ResponseFileDefaults::max_depth) {
+      return fail(state, ParseErrorCode::RESPONSE_FILE_TOO_DEEP, path);
+    }
+    auto &files = state.validate ? validated_files_ : response_files_;
+    ResponseFile &file = *files.emplace_back(
+        ResourceDeleter<ResponseFile>::make<ResponseFile>(resource_, path));
+    if (!file.is_open()) {
+      return fail(state, ParseErrorCode::RESPONSE_FILE_UNREADABLE, path);
+    }
+    std::string_view token;
+    while (file.next(token)) {
+      if (!parse_arg(state, token, &file, depth)) {
+        return false;
+      }
+    }
+    if (file.unterminated()) {
+      return fail(state, ParseErrorCode::UNTERMINATED_QUOTE, path);
+    }
+    file.release();
+    return true;
+  }
+  bool next_flag(ParseState &state, Flag &flag, std::string_view arg) {
+    // closing first sets the previous flag, which may be this one
+    if (!close_flag(state)) {
+      return false;
+    }
+    if (state.validate ? seen_[flag.index_] : flag.is_set()) {
+      return fail(state, ParseErrorCode::REPEATED_FLAG, arg);
+    }
+    if (state.validate) {
+      seen_[flag.index_] = true;
+    }
+    state.current_flag = &flag;
+    state.flag_arg = arg;
+    state.flag_position = state.position;
+    state.params_begin = args_.size();
+    state.param_count = 0;
+    return true;
+  }
+  bool close_flag(ParseState &state) {
+    Flag *flag = state.current_flag;
+    if (!flag) {
+      return true;
+    }
+    if (!flag->accepts(state.param_count)) {
+      state.error = ParseError{ParseErrorCode::WRONG_PARAM_COUNT,
+                               state.flag_position, state.flag_arg,
+                               flag->param_count_, state.param_count};
+      return false;
+    }
+    if (state.validate) {
+      return true;
+    }
+    std::size_t failed =
+        flag->set(flag_params_t{args_}.subspan(state.params_begin));
+    state.set_flags.push_back({flag, state.params_begin, args_.size()});
+    if (failed != Flag::npos) {
+      state.error = invalid_param(state.params_begin + failed).error();
+      return false;
+    }
+    return true;
+  }
+  bool push_param(ParseState &state, std::string_view param,
+                  ResponseFile *file) {
+    state.param_count++;
+    if (state.validate) {
+      return true;
+    }
+    args_.emplace_back(param);
+    positions_.emplace_back(state.position);
+    Flag &flag = *state.current_flag;
+    if (!flag.is_streamed()) {
+      if (file) {
+        file->pin(param);
+      }
+    } else if (args_.size() - state.params_begin >= flag.chunk_size_) {
+      flag.stream(flag_params_t{args_}.subspan(state.params_begin));
+      args_.resize(state.params_begin);
+      positions_.resize(state.params_begin);
+      if (file) {
+        file->release();
+      }
+    }
+    return true;
+  }
+  // Runs the deferred callbacks of the set flags. Errors are reported in
+  // command-line order, and flags depending on one that failed are skipped.
+  ParseResult<> run_deferred(ParseState &state) {
+    auto &set_flags = state.set_flags;
+    bool ordered = std::any_of(set_flags.begin(), set_flags.end(),
+                               [](const ParseState::SetFlag &set) {
+                                 return !set.flag->dependencies_.empty();
+                               });
+    if (parse_threads_ <= 1 && !ordered) {
+      for (auto [flag, begin, end] : set_flags) {
+        auto span = tracer_.span(flag->name_.c_str(), "flag");
+        if (std::size_t failed = flag->parse(); failed != Flag::npos) {
+          return invalid_param(begin + failed);
+        }
+      }
+      return {};
+    }
+    std::pmr::vector<WorkPool::Edge> edges = dependency_edges(set_flags);
+    struct Outcome {
+      std::size_t failed = Flag::npos;
+      std::exception_ptr exception;
+      bool skipped = false;
+
+      bool ok() const { return failed == Flag::npos && !exception && !skipped; }
+    };
+    std::pmr::vector<Outcome> outcomes(set_flags.size(), resource_);
+    auto job = [&](uint32_t index) {
+      Outcome &outcome = outcomes[index];
+      for (WorkPool::Edge edge : edges) {
+        if (edge.to == index && !outcomes[edge.from].ok()) {
+          outcome.skipped = true;
+          return;
+        }
+      }
+      Flag &flag = *set_flags[index].flag;
+      auto span = tracer_.span(flag.name_.c_str(), "flag");
+      try {
+        outcome.failed = flag.parse();
+      } catch (...) {
+        outcome.exception = std::current_exception();
+      }
+    };
+    WorkPool pool{parse_threads_, resource_};
+    if (!pool.run(set_flags.size(), edges, job)) {
+      throw Exception(ExceptionType::CONFIGURATION,
+                      "flag dependencies form a cycle.");
+    }
+    for (std::size_t i = 0; i < set_flags.size(); i++) {
+      if (outcomes[i].exception) {
+        std::rethrow_exception(outcomes[i].exception);
+      }
+      if (outcomes[i].failed != Flag::npos) {
+        return invalid_param(set_flags[i].begin + outcomes[i].failed);
+      }
+    }
+    return {};
+  }
+  // Dependencies between set flags, by their index in set_flags; those on
+  // flags that were not set impose no order.
+  std::pmr::vector<WorkPool::Edge>
+  dependency_edges(std::span<const ParseState::SetFlag> set_flags) {
+    std::pmr::vector<uint32_t> set_index(flags_.size(), UINT32_MAX, resource_);
+    for (std::size_t i = 0; i < set_flags.size(); i++) {
+      set_index[set_flags[i].flag->index_] = i;
+    }
+    std::pmr::vector<WorkPool::Edge> edges{resource_};
+    for (std::size_t i = 0; i < set_flags.size(); i++) {
+      for (const std::pmr::string &name : set_flags[i].flag->dependencies_) {
+        auto dependency = flags_.find(name);
+        if (dependency == flags_.end()) {
+          throw Exception(ExceptionType::CONFIGURATION,
+                          set_flags[i].flag->name() + " depends on " +
+                              std::string{name} + ", which is not a flag.");
+        }
+        uint32_t from = set_index[dependency->second.index_];
+        if (from != UINT32_MAX) {
+          edges.push_back({from, static_cast<uint32_t>(i)});
+        }
+      }
+    }
+    return edges;
+  }
+  bool fail(ParseState &state, ParseErrorCode code, std::string_view arg) {
+    state.error = ParseError{code, state.position, arg};
+    return false;
+  }
+  ParseResult<> invalid_param(std::size_t index) {
+    return ParseError{ParseErrorCode::INVALID_PARAM, positions_[index],
+                      args_[index]};
+  }
+
+  /* Subcommands */
+  struct Subcommand {
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
+    Subcommand(std::string_view description, subcommand_factory_t factory,
+               const allocator_type &allocator)
+        : description{description, allocator}, factory{std::move(factory)} {}
+
+    std::pmr::string description;
+    subcommand_factory_t factory;
+  };
+  using subcommand_ptr_t = std::unique_ptr<QuikCli, ResourceDeleter<QuikCli>>;
+
+  static bool names_flag(std::string_view arg, std::string_view name,
+                         char alias) {
+    return (arg.starts_with("--") && arg.substr(2) == name) ||
+           (arg.length() == 2 && arg[0] == '-' && arg[1] == alias);
+  }
+  bool names_subcommand(const ParseState &state, std::string_view arg) const {
+    if (subcommands_.empty() || arg.empty() || arg[0] == '-' ||
+        arg[0] == ResponseFileDefaults::prefix) {
+      return false;
+    }
+    const Flag *flag = state.current_flag;
+    if (!flag) {
+      return true;
+    }
+    if (flag->param_count_ == FlagParamSize::VARIADIC) {
+      return subcommands_.contains(arg);
+    }
+    return state.param_count >= flag->param_count_;
+  }
+  subcommand_ptr_t
+  make_subcommand(std::pair<const std::pmr::string, Subcommand> &subcommand) {
+    std::pmr::string path{name_, resource_};
+    path += ' ';
+    path += subcommand.first;
+    subcommand_ptr_t cli = ResourceDeleter<QuikCli>::make<QuikCli>(
+        resource_, SubcommandTag{}, path, version_, resource_);
+    cli->parse_threads_ = parse_threads_;
+    cli->writer.share_logs(writer);
+    cli->writer.set_session(writer.session());
+    cli->writer.set_headless(writer.headless());
+    if (render_rate_ > 0) {
+      cli->set_render_rate(render_rate_);
+    }
+    subcommand.second.factory(*cli);
+    return cli;
+  }
+  // Errors from a subcommand are positioned within its own argv, which starts
+  // at offset in ours.
+  static ParseResult<> shift(ParseResult<> result, int offset) {
+    if (result) {
+      return result;
+    }
+    ParseError error = result.error();
+    error.position += offset;
+    return error;
+  }
 
   /* Helpers */
-  void check_dup_flag(std::string &name) {
+  // Whether neither this command nor the subcommand it ran called exit().
+  bool completed() const {
+    for (const QuikCli *cli = this; cli; cli = cli->subcommand_.get()) {
+      if (!cli->is_active_) {
+        return false;
+      }
+    }
+    return true;
+  }
+  void prefetch() {
+    std::size_t depth = std::min(components.size(), prefetch_depth_ + 1);
+    for (std::size_t i = 1; i < depth; i++) {
+      if (auto async = dynamic_cast<AsyncComponent *>(components[i].get())) {
+        async->prefetch(scheduler_);
+      }
+    }
+    scheduler_.poll();
+  }
+  void set_session(std::string path, Session::Mode mode) {
+    session_ = std::make_unique<Session>(std::move(path), mode);
+    writer.set_session(session_.get());
+    // A subcommand already built by parse_flags copied the writer's state
+    // before there was a session.
+    for (QuikCli *cli = subcommand_.get(); cli; cli = cli->subcommand_.get()) {
+      cli->writer.set_session(session_.get());
+      cli->writer.set_headless(writer.headless());
+    }
+  }
+  void check_dup_flag(std::string_view name) {
     if (flags_.contains(name)) {
       throw Exception(ExceptionType::CONFIGURATION,
-                      "flag " + name + " has been repeated.");
+                      "flag " + std::string{name} + " has been repeated.");
     }
   }
+  // Builds the flag in place, so its strings come from resource_ too.
+  template <class... ArgsT>
+  Flag &register_flag(std::string_view name, ArgsT &&...args) {
+    Flag &registered =
+        flags_
+            .emplace(std::piecewise_construct, std::forward_as_tuple(name),
+                     std::forward_as_tuple(name, std::forward<ArgsT>(args)...))
+            .first->second;
+    registered.aliases_ = &aliases_;
+    registered.index_ = flags_.size() - 1;
+    return registered;
+  }
 
 private:
+  using component_ptr_t =
+      std::unique_ptr<Component, ResourceDeleter<Component>>;
+
+  /* Memory */
+  std::pmr::memory_resource *resource_;
+
   /* Cli Information */
   bool is_active_ = true;
-  std::string name_;
-  std::string version_;
-  std::map<std::string, Flag> flags_;
+  std::pmr::string name_;
+  std::pmr::string version_;
+  std::pmr::map<std::pmr::string, Flag, std::less<>> flags_{resource_};
+  alias_table_t aliases_{};
+  std::pmr::map<std::pmr::string, Subcommand, std::less<>> subcommands_{
+      resource_};
+  subcommand_ptr_t subcommand_;
+  std::pmr::map<std::pmr::string, subcommand_ptr_t, std::less<>> validators_{
+      resource_};
+
+  /* Parsed Arguments */
+  using response_file_ptr_t =
+      std::unique_ptr<ResponseFile, ResourceDeleter<ResponseFile>>;
+
+  std::pmr::vector<std::string_view> args_{resource_};
+  // the argv index each of args_ came from
+  std::pmr::vector<int> positions_{resource_};
+  // mapped for as long as args_ may point into them
+  std::pmr::vector<response_file_ptr_t> response_files_{resource_};
+  // mapped until the next validation, for the views in its ParseError
+  std::pmr::vector<response_file_ptr_t> validated_files_{resource_};
+  std::pmr::vector<bool> seen_ = std::pmr::vector<bool>(resource_);
+
+  /* Instrumentation */
+  Tracer tracer_;
 
   /* Components to Render */
-  std::deque<std::unique_ptr<Component>> components;
+  // declared ahead of the components so that it outlives their tasks
+  Scheduler scheduler_;
+  std::size_t prefetch_depth_ = 1;
+  std::size_t parse_threads_ = 1;
+  uint32_t render_rate_ = 0;
+  // shared with subcommands through their writers
+  std::unique_ptr<Session> session_;
+  std::pmr::deque<component_ptr_t> components{resource_};
 
   Writer writer;
 };
@@ -0,0 +1,81 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_RENDER_H_
+#define QC_RENDER_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace quikcli {
+
+// Hands the latest of a series of values from one thread to another without
+// either ever waiting on the other. The producer fills back() and publish()
+// swaps it with the middle buffer; the consumer's acquire() swaps the middle
+// buffer in as its front() if anything was published since. Values published
+// in between are dropped, and buffers are reused, so a producer that assigns
+// into back() stops allocating once the buffers have grown.
+template <class T> class TripleBuffer {
+public:
+  /* Producer */
+  T &back() { return buffers_[back_]; }
+  void publish() {
+    uint8_t previous =
+        middle_.exchange(back_ | fresh, std::memory_order_acq_rel);
+    back_ = previous & index_mask;
+  }
+
+  /* Consumer */
+  // Returns false, keeping the current front(), if nothing new was published.
+  bool acquire() {
+    if (!(middle_.load(std::memory_order_relaxed) & fresh)) {
+      return false;
+    }
+    uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+    front_ = previous & index_mask;
+    return true;
+  }
+  const T &front() const { return buffers_[front_]; }
+  // Whether acquire() would find something new.
+  bool pending() const {
+    return middle_.load(std::memory_order_relaxed) & fresh;
+  }
+
+private:
+  static constexpr uint8_t index_mask = 0x3;
+  static constexpr uint8_t fresh = 0x4;
+
+  std::array<T, 3> buffers_{};
+  uint8_t back_ = 0;
+  uint8_t front_ = 1;
+  std::atomic<uint8_t> middle_ = 2;
+};
+
+} // namespace quikcli
+
+#endif // QC_RENDER_H_
@@ -0,0 +1,181 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_RESPONSE_H_
+#define QC_RESPONSE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace quikcli {
+
+// A response file (@path) of whitespace separated arguments. Single quotes
+// keep everything up to the closing quote, double quotes keep everything but
+// backslash escapes, and a backslash outside of quotes escapes the next
+// character. The file is mapped copy-on-write and unescaped in place, so
+// tokens are views into the mapping that last as long as the ResponseFile.
+// Errors are reported through is_open() and unterminated() rather than
+// thrown, so that parsing never has to unwind.
+class ResponseFile {
+public:
+  /* Constructors & Destructors - No Copy No Move */
+  explicit ResponseFile(std::string_view path) {
+    int fd = open(std::string{path}.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+      close(fd);
+      return;
+    }
+    size_ = info.st_size;
+    if (size_ > 0) {
+      void *data =
+          mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        close(fd);
+        size_ = 0;
+        return;
+      }
+      data_ = static_cast<char *>(data);
+      madvise(data_, size_, MADV_SEQUENTIAL);
+    }
+    close(fd);
+    open_ = true;
+    cursor_ = pinned_ = released_ = data_;
+  }
+
+  ResponseFile(ResponseFile &) = delete;
+  ResponseFile &operator=(ResponseFile &) = delete;
+  ResponseFile(ResponseFile &&) = delete;
+  ResponseFile &operator=(ResponseFile &&) = delete;
+
+  ~ResponseFile() {
+    if (data_) {
+      munmap(data_, size_);
+    }
+  }
+
+public:
+  /* Getters */
+  bool is_open() const { return open_; }
+  // Whether reading stopped at a quote that was never closed.
+  bool unterminated() const { return unterminated_; }
+
+  /* Tokenizing */
+  // Returns false once every token has been read, or at an unterminated
+  // quote.
+  bool next(std::string_view &token) {
+    char *end = data_ + size_;
+    while (cursor_ < end && is_space(*cursor_)) {
+      cursor_++;
+    }
+    if (cursor_ == end) {
+      return false;
+    }
+    char *begin = cursor_;
+    char *out = cursor_;
+    char quote = '\0';
+    for (; cursor_ < end; cursor_++) {
+      char c = *cursor_;
+      if (quote == '\'') {
+        if (c == '\'') {
+          quote = '\0';
+        } else {
+          *out++ = c;
+        }
+      } else if (c == '\\' && cursor_ + 1 < end) {
+        *out++ = *++cursor_;
+      } else if (quote == '"') {
+        if (c == '"') {
+          quote = '\0';
+        } else {
+          *out++ = c;
+        }
+      } else if (c == '\'' || c == '"') {
+        quote = c;
+      } else if (is_space(c)) {
+        break;
+      } else {
+        *out++ = c;
+      }
+    }
+    if (quote != '\0') {
+      unterminated_ = true;
+      return false;
+    }
+    token = {begin, static_cast<std::size_t>(out - begin)};
+    return true;
+  }
+
+  /* Memory */
+  // Keeps the pages holding token, which must come from this file, for as long
+  // as the file is open.
+  void pin(std::string_view token) {
+    pinned_ =
+        std::max(pinned_, const_cast<char *>(token.data() + token.size()));
+  }
+  // Drops the pages of everything read so far that was not pinned. Reading
+  // them again would see the file's original contents.
+  void release() {
+    std::size_t page = sysconf(_SC_PAGESIZE);
+    std::size_t from = std::max(pinned_, released_) - data_;
+    std::size_t to = (cursor_ - data_) / page * page;
+    from = (from + page - 1) / page * page;
+    if (from < to) {
+      madvise(data_ + from, to - from, MADV_DONTNEED);
+      released_ = data_ + to;
+    }
+  }
+
+private:
+  static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' ||
+           c == '\f';
+  }
+
+private:
+  bool open_ = false;
+  bool unterminated_ = false;
+  char *data_ = nullptr;
+  std::size_t size_ = 0;
+  char *cursor_ = nullptr;
+  char *pinned_ = nullptr;
+  char *released_ = nullptr;
+};
+
+} // namespace quikcli
+
+#endif // QC_RESPONSE_H_
@@ -0,0 +1,148 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_RESULT_H_
+#define QC_RESULT_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+#include "quikcli/exception.h"
+
+namespace quikcli {
+
+enum class ParseErrorCode : uint8_t {
+  UNKNOWN_FLAG = 0,
+  UNEXPECTED_ARGUMENT = 1,
+  REPEATED_FLAG = 2,
+  WRONG_PARAM_COUNT = 3,
+  INVALID_PARAM = 4,
+  UNKNOWN_COMMAND = 5,
+  RESPONSE_FILE_UNREADABLE = 6,
+  RESPONSE_FILE_TOO_DEEP = 7,
+  UNTERMINATED_QUOTE = 8,
+};
+
+// Describes why a command line was rejected without formatting a message;
+// message() builds one on request. arg views the argument at fault (the path,
+// for response file errors) and stays valid until the next parse.
+struct ParseError {
+  ParseErrorCode code;
+  // index into argv of the argument at fault; arguments read from a response
+  // file report the index of the @path that named it
+  int position = 0;
+  std::string_view arg;
+  // parameter counts, for WRONG_PARAM_COUNT
+  uint32_t expected = 0;
+  uint32_t received = 0;
+
+  ExceptionType type() const {
+    return code == ParseErrorCode::RESPONSE_FILE_UNREADABLE
+               ? ExceptionType::IO
+               : ExceptionType::PARSER;
+  }
+  std::string message() const {
+    std::string str{arg};
+    switch (code) {
+    case ParseErrorCode::UNKNOWN_FLAG:
+      return str + " is not a valid flag.";
+    case ParseErrorCode::UNEXPECTED_ARGUMENT:
+      return "Expected flag but got \"" + str + "\".";
+    case ParseErrorCode::REPEATED_FLAG:
+      return str + " has already been set.";
+    case ParseErrorCode::WRONG_PARAM_COUNT:
+      return "expected " + std::to_string(expected) + " arguments, got " +
+             std::to_string(received) + ".";
+    case ParseErrorCode::INVALID_PARAM:
+      return "failed to parse argument " + str;
+    case ParseErrorCode::UNKNOWN_COMMAND:
+      return "\"" + str + "\" is not a valid command.";
+    case ParseErrorCode::RESPONSE_FILE_UNREADABLE:
+      return "failed to open " + str + ".";
+    case ParseErrorCode::RESPONSE_FILE_TOO_DEEP:
+      return "response files nested too deeply at @" + str + ".";
+    case ParseErrorCode::UNTERMINATED_QUOTE:
+      return "unterminated quote in " + str + ".";
+    }
+    return "unknown error.";
+  }
+  Exception exception() const { return Exception(type(), message()); }
+};
+
+// Either a value or the ParseError that prevented it, along the lines of
+// std::expected<T, ParseError>.
+template <class T = void> class ParseResult {
+public:
+  ParseResult(T value) : result_{std::in_place_index<0>, std::move(value)} {}
+  ParseResult(ParseError error)
+      : result_{std::in_place_index<1>, std::move(error)} {}
+
+public:
+  bool has_value() const { return result_.index() == 0; }
+  explicit operator bool() const { return has_value(); }
+  // Throws the error as an Exception if there is no value.
+  T &value() {
+    if (!has_value()) {
+      throw error().exception();
+    }
+    return std::get<0>(result_);
+  }
+  T &operator*() { return std::get<0>(result_); }
+  T *operator->() { return &std::get<0>(result_); }
+  const ParseError &error() const { return std::get<1>(result_); }
+
+private:
+  std::variant<T, ParseError> result_;
+};
+
+template <> class ParseResult<void> {
+public:
+  ParseResult() = default;
+  ParseResult(ParseError error) : error_{std::move(error)} {}
+
+public:
+  bool has_value() const { return !error_.has_value(); }
+  explicit operator bool() const { return has_value(); }
+  // Throws the error as an Exception if there is one.
+  void value() const {
+    if (error_.has_value()) {
+      throw error_->exception();
+    }
+  }
+  const ParseError &error() const { return *error_; }
+
+private:
+  std::optional<ParseError> error_;
+};
+
+} // namespace quikcli
+
+#endif // QC_RESULT_H_
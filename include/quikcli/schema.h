@@ -0,0 +1,394 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_SCHEMA_H_
+#define QC_SCHEMA_H_
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "quikcli/constants.h"
+#include "quikcli/exception.h"
+#include "quikcli/result.h"
+
+namespace quikcli {
+
+struct FlagSpec {
+  std::string_view name;
+  std::string_view description;
+  char alias = '\0';
+  uint32_t param_count = FlagParamSize::EMPTY;
+};
+
+template <std::size_t N> class SchemaArgs;
+
+// The parameters of a flag matched against a FlagSchema: the value attached
+// by --name=value, if any, then the arguments that followed the flag.
+class SchemaParams {
+public:
+  class Iterator {
+  public:
+    using value_type = const char *;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() = default;
+    Iterator(const SchemaParams *params, std::size_t index)
+        : params_{params}, index_{index} {}
+
+    const char *operator*() const { return (*params_)[index_]; }
+    Iterator &operator++() {
+      index_++;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator previous = *this;
+      index_++;
+      return previous;
+    }
+    bool operator==(const Iterator &other) const {
+      return index_ == other.index_;
+    }
+
+  private:
+    const SchemaParams *params_ = nullptr;
+    std::size_t index_ = 0;
+  };
+
+  SchemaParams() = default;
+  SchemaParams(const char *attached, std::span<char *const> following)
+      : attached_{attached}, following_{following} {}
+
+public:
+  std::size_t size() const {
+    return (attached_ != nullptr) + following_.size();
+  }
+  bool empty() const { return size() == 0; }
+  const char *operator[](std::size_t index) const {
+    if (!attached_) {
+      return following_[index];
+    }
+    return index == 0 ? attached_ : following_[index - 1];
+  }
+  Iterator begin() const { return {this, 0}; }
+  Iterator end() const { return {this, size()}; }
+
+private:
+  const char *attached_ = nullptr;
+  std::span<char *const> following_;
+};
+
+// A flag schema declared at compile time, e.g.
+//
+//   constexpr quikcli::FlagSchema schema{{
+//       {"output", "file to write to.", 'o', 1},
+//       {"verbose", "print more output.", 'v'},
+//   }};
+//
+// Names resolve through a hash-and-displace perfect hash built by the compiler
+// and aliases through a direct lookup table, so parsing against a schema never
+// touches the heap. Duplicate names or aliases fail to compile.
+template <std::size_t N> class FlagSchema {
+  static_assert(N < 0xFFFF, "too many flags in schema.");
+
+public:
+  consteval FlagSchema(const FlagSpec (&specs)[N]) {
+    for (std::size_t i = 0; i < N; i++) {
+      if (specs[i].name.empty()) {
+        throw "flag names must not be empty.";
+      }
+      if (specs[i].alias < 0) {
+        throw "flag aliases must be ascii.";
+      }
+      if (specs[i].alias != '\0') {
+        if (aliases_[specs[i].alias] != 0) {
+          throw "alias has already been assigned.";
+        }
+        aliases_[specs[i].alias] = i + 1;
+      }
+      specs_[i] = specs[i];
+    }
+    build_table();
+  }
+
+public:
+  /* Getters */
+  static constexpr std::size_t size() { return N; }
+  constexpr std::span<const FlagSpec> specs() const { return specs_; }
+  constexpr const FlagSpec &operator[](std::size_t index) const {
+    return specs_[index];
+  }
+
+  /* Lookup */
+  constexpr std::optional<std::size_t> find(std::string_view name) const {
+    if constexpr (N == 0) {
+      return std::nullopt;
+    } else {
+      uint32_t displacement = displacements_[hash(name, 0) & bucket_mask];
+      uint16_t slot = slots_[hash(name, displacement) & slot_mask];
+      if (slot == 0 || specs_[slot - 1].name != name) {
+        return std::nullopt;
+      }
+      return slot - 1;
+    }
+  }
+  constexpr std::optional<std::size_t> find(char alias) const {
+    if (alias <= 0 || aliases_[alias] == 0) {
+      return std::nullopt;
+    }
+    return aliases_[alias] - 1;
+  }
+
+  /* Parsing */
+  ParseResult<SchemaArgs<N>> try_parse(int argc, char *argv[]) const {
+    SchemaArgs<N> args{*this, argv};
+    if (std::optional<ParseError> error = args.read(argc)) {
+      return *error;
+    }
+    return args;
+  }
+  SchemaArgs<N> parse(int argc, char *argv[]) const {
+    return std::move(try_parse(argc, argv).value());
+  }
+
+private:
+  static constexpr std::size_t slot_count = std::bit_ceil(N + N / 2 + 1);
+  static constexpr std::size_t slot_mask = slot_count - 1;
+  static constexpr std::size_t bucket_count = std::bit_ceil(N / 4 + 1);
+  static constexpr std::size_t bucket_mask = bucket_count - 1;
+
+  static constexpr uint32_t hash(std::string_view name, uint32_t seed) {
+    uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (char c : name) {
+      h ^= static_cast<unsigned char>(c);
+      h *= 16777619u;
+    }
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+  }
+
+  // Hash and displace: keys are split into buckets by a first hash, then,
+  // largest bucket first, each bucket searches for a seed that sends all of
+  // its keys to free slots.
+  consteval void build_table() {
+    // counting sort of the keys by bucket
+    std::array<std::size_t, bucket_count + 1> bucket_begin{};
+    for (std::size_t i = 0; i < N; i++) {
+      bucket_begin[(hash(specs_[i].name, 0) & bucket_mask) + 1]++;
+    }
+    for (std::size_t b = 0; b < bucket_count; b++) {
+      bucket_begin[b + 1] += bucket_begin[b];
+    }
+    std::array<std::size_t, N> keys{};
+    std::array<std::size_t, bucket_count> filled{};
+    for (std::size_t i = 0; i < N; i++) {
+      std::size_t bucket = hash(specs_[i].name, 0) & bucket_mask;
+      keys[bucket_begin[bucket] + filled[bucket]++] = i;
+    }
+    std::array<bool, bucket_count> placed{};
+    for (std::size_t round = 0; round < bucket_count; round++) {
+      std::size_t bucket = 0;
+      std::size_t largest = 0;
+      for (std::size_t b = 0; b < bucket_count; b++) {
+        if (!placed[b] && filled[b] >= largest) {
+          bucket = b;
+          largest = filled[b];
+        }
+      }
+      placed[bucket] = true;
+      if (largest == 0) {
+        continue;
+      }
+      std::span<const std::size_t> members{keys.data() + bucket_begin[bucket],
+                                           largest};
+      for (uint32_t seed = 1;; seed++) {
+        if (seed == 0xFFFFFF) {
+          throw "failed to build flag table.";
+        }
+        if (try_place(members, seed)) {
+          displacements_[bucket] = seed;
+          break;
+        }
+      }
+    }
+  }
+  consteval bool try_place(std::span<const std::size_t> members,
+                           uint32_t seed) {
+    std::size_t count = 0;
+    for (; count < members.size(); count++) {
+      std::string_view name = specs_[members[count]].name;
+      std::size_t slot = hash(name, seed) & slot_mask;
+      if (slots_[slot] != 0) {
+        if (specs_[slots_[slot] - 1].name == name) {
+          throw "flag has been repeated.";
+        }
+        break;
+      }
+      slots_[slot] = members[count] + 1;
+    }
+    if (count == members.size()) {
+      return true;
+    }
+    for (std::size_t i = 0; i < count; i++) {
+      slots_[hash(specs_[members[i]].name, seed) & slot_mask] = 0;
+    }
+    return false;
+  }
+
+private:
+  std::array<FlagSpec, N> specs_{};
+  std::array<uint16_t, slot_count> slots_{};
+  std::array<uint32_t, bucket_count> displacements_{};
+  std::array<uint16_t, 128> aliases_{};
+};
+
+// The flags matched against a FlagSchema. Parameters are kept as ranges of the
+// original argv rather than copies. The grammar is that of
+// QuikCli::parse_flags: --name, -a, --name=value, and chained aliases (-abc,
+// where only the last alias takes the following parameters). Response files
+// are not expanded.
+template <std::size_t N> class SchemaArgs {
+public:
+  // No flags set, e.g. in place of a rejected command line.
+  explicit SchemaArgs(const FlagSchema<N> &schema)
+      : SchemaArgs(schema, nullptr) {}
+
+public:
+  /* Getters */
+  bool is_set(std::size_t index) const { return entries_[index].set; }
+  bool is_set(std::string_view name) const {
+    std::optional<std::size_t> index = schema_->find(name);
+    return index.has_value() && is_set(*index);
+  }
+  SchemaParams params(std::size_t index) const {
+    const Entry &entry = entries_[index];
+    return {entry.attached,
+            {argv_ + entry.begin, entry.count - (entry.attached != nullptr)}};
+  }
+  SchemaParams params(std::string_view name) const {
+    std::optional<std::size_t> index = schema_->find(name);
+    return index.has_value() ? params(*index) : SchemaParams{};
+  }
+
+private:
+  struct Entry {
+    bool set = false;
+    int begin = 0;
+    // including the attached value
+    uint32_t count = 0;
+    const char *attached = nullptr;
+  };
+
+  SchemaArgs(const FlagSchema<N> &schema, char *argv[])
+      : schema_{&schema}, argv_{argv} {}
+
+  std::optional<ParseError> read(int argc) {
+    Entry *current = nullptr;
+    for (int i = 1; i < argc; i++) {
+      std::string_view arg = argv_[i];
+      if (arg.length() >= 2 && arg[0] == '-' && arg[1] == '-') {
+        std::string_view name = arg.substr(2);
+        std::size_t equals = name.find('=');
+        std::optional<std::size_t> index =
+            schema_->find(name.substr(0, equals));
+        if (!index.has_value()) {
+          return ParseError{ParseErrorCode::UNKNOWN_FLAG, i, arg};
+        }
+        if (std::optional<ParseError> error = open(current, *index, i, arg)) {
+          return error;
+        }
+        if (equals != std::string_view::npos) {
+          current->attached = argv_[i] + 2 + equals + 1;
+          current->count = 1;
+        }
+      } else if (arg.length() >= 2 && arg[0] == '-') {
+        for (char alias : arg.substr(1)) {
+          std::optional<std::size_t> index = schema_->find(alias);
+          if (!index.has_value()) {
+            return ParseError{ParseErrorCode::UNKNOWN_FLAG, i, arg};
+          }
+          if (std::optional<ParseError> error =
+                  open(current, *index, i, arg)) {
+            return error;
+          }
+        }
+      } else {
+        if (!current) {
+          return ParseError{ParseErrorCode::UNEXPECTED_ARGUMENT, i, arg};
+        }
+        current->count++;
+      }
+    }
+    return check(current);
+  }
+  // Closes the current flag, then starts the one at index.
+  std::optional<ParseError> open(Entry *&current, std::size_t index, int i,
+                                 std::string_view arg) {
+    // closing first checks the previous flag, which may be this one
+    if (std::optional<ParseError> error = check(current)) {
+      return error;
+    }
+    if (entries_[index].set) {
+      return ParseError{ParseErrorCode::REPEATED_FLAG, i, arg};
+    }
+    current = &entries_[index];
+    current->set = true;
+    current->begin = i + 1;
+    return std::nullopt;
+  }
+  std::optional<ParseError> check(const Entry *entry) const {
+    if (!entry) {
+      return std::nullopt;
+    }
+    uint32_t param_count = (*schema_)[entry - entries_.data()].param_count;
+    if (param_count != FlagParamSize::VARIADIC &&
+        entry->count != param_count) {
+      return ParseError{ParseErrorCode::WRONG_PARAM_COUNT, entry->begin - 1,
+                        argv_[entry->begin - 1], param_count, entry->count};
+    }
+    return std::nullopt;
+  }
+
+  friend class FlagSchema<N>;
+
+private:
+  const FlagSchema<N> *schema_;
+  char **argv_;
+  std::array<Entry, N> entries_{};
+};
+
+} // namespace quikcli
+
+#endif // QC_SCHEMA_H_
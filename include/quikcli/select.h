@@ -0,0 +1,295 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_SELECT_H_
+#define QC_SELECT_H_
+
+#include <algorithm>
+#include <charconv>
+#include <csignal>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "quikcli/component.h"
+#include "quikcli/exception.h"
+#include "quikcli/fuzzy.h"
+#include "quikcli/terminal.h"
+#include "quikcli/writer.h"
+
+namespace quikcli {
+
+// Picks one of a list of options by typing to fuzzy filter it and moving
+// through the matches with the arrow or page keys. Each typed character only
+// rescores the options that matched before it, deleting one returns to the
+// matches kept for the shorter query, and only the visible rows are sorted.
+// ESC, ctrl-c or ctrl-d cancels, raising SIGINT as ctrl-c does in the other
+// components, and the callback is not called. Off a terminal, a line is read
+// from stdin and taken as either the 1-based number of an option or a query
+// for the best match; the end of input cancels, and a line that matches no
+// option throws. A replayed session supplies the option chosen instead.
+class Select : public Component {
+public:
+  struct Match {
+    uint32_t index;
+    int score;
+  };
+
+  /* Constructors & Destructors - No Copy Default Move */
+  Select(std::string prompt, std::vector<std::string> options,
+         str_callback_t callback)
+      : prompt_{std::move(prompt)}, options_{std::move(options)},
+        callback_{std::move(callback)} {}
+
+  Select(Select &) = delete;
+  Select &operator=(Select &) = delete;
+  Select(Select &&) = default;
+  Select &operator=(Select &&) = default;
+
+public:
+  /* Configuration */
+  Select &set_rows(std::size_t rows) {
+    rows_ = std::max<std::size_t>(rows, 1);
+    return *this;
+  }
+
+  /* Filtering */
+  // Narrows the matches down to query, reusing the matches of its longest
+  // prefix that was already filtered.
+  const std::vector<Match> &filter(std::string_view query) {
+    if (history_.empty()) {
+      history_.emplace_back(options_.size());
+      for (uint32_t i = 0; i < options_.size(); i++) {
+        history_[0][i] = {i, 0};
+      }
+    } else if (query == query_) {
+      return history_.back();
+    }
+    std::size_t common = 0;
+    while (common < query.size() && common < query_.size() &&
+           query[common] == query_[common]) {
+      common++;
+    }
+    history_.resize(common + 1);
+    query_.assign(query.substr(0, common));
+    for (std::size_t length = common + 1; length <= query.size(); length++) {
+      FuzzyMatcher matcher{query.substr(0, length)};
+      const std::vector<Match> &previous = history_.back();
+      std::vector<Match> next;
+      for (const Match &match : previous) {
+        int score = matcher.score(options_[match.index]);
+        if (score != FuzzyMatcher::no_match) {
+          next.push_back({match.index, score});
+        }
+      }
+      history_.push_back(std::move(next));
+      query_ += query[length - 1];
+    }
+    sorted_ = 0;
+    return history_.back();
+  }
+  // Orders the current matches by score far enough to show the first count.
+  void sort(std::size_t count) {
+    std::vector<Match> &matches = history_.back();
+    count = std::min(count, matches.size());
+    if (count <= sorted_) {
+      return;
+    }
+    std::partial_sort(matches.begin() + sorted_, matches.begin() + count,
+                      matches.end(), [](const Match &a, const Match &b) {
+                        return a.score != b.score ? a.score > b.score
+                                                  : a.index < b.index;
+                      });
+    sorted_ = count;
+  }
+
+  void run(Writer &writer) override {
+    std::optional<std::string> selected;
+    Session *session = writer.session();
+    if (session && session->replaying()) {
+      selected = session->next(name());
+    } else {
+      std::optional<RawMode> raw_mode;
+      if (is_interactive(writer.fd())) {
+        raw_mode.emplace();
+      }
+      if (raw_mode && raw_mode->active()) {
+        selected = choose(writer);
+      } else {
+        writer.out(prompt_);
+        if (std::string line; std::getline(std::cin, line)) {
+          selected = pick(line);
+        }
+      }
+    }
+    if (!selected) {
+      std::raise(SIGINT);
+      return;
+    }
+    if (session) {
+      session->record(name(), *selected);
+    }
+    auto span = writer.trace("Select callback");
+    callback_(*selected);
+  }
+  const char *name() const override { return "Select"; }
+
+private:
+  // Returns nothing if the selection was cancelled or the input closed.
+  std::optional<std::string> choose(Writer &writer) {
+    KeyReader reader;
+    std::vector<KeyEvent> events;
+    std::string query;
+    std::size_t cursor = 0;
+    while (true) {
+      const std::vector<Match> &matches = filter(query);
+      cursor = std::min(cursor, matches.empty() ? 0 : matches.size() - 1);
+      top_ = std::min(top_, cursor);
+      top_ = cursor >= top_ + rows_ ? cursor + 1 - rows_ : top_;
+      sort(top_ + rows_);
+      render(writer, query, cursor, true);
+      if (!reader.read(events)) {
+        render(writer, query, cursor, false);
+        return std::nullopt;
+      }
+      for (const KeyEvent &event : events) {
+        switch (event.key) {
+        case Key::CHAR:
+          query += event.ch;
+          cursor = 0;
+          break;
+        case Key::BACKSPACE:
+          if (!query.empty()) {
+            query.pop_back();
+            cursor = 0;
+          }
+          break;
+        case Key::CONTROL:
+          if (event.ch == 'U') {
+            query.clear();
+            cursor = 0;
+          }
+          break;
+        case Key::UP:
+          cursor = cursor > 0 ? cursor - 1 : 0;
+          break;
+        case Key::DOWN:
+          cursor++;
+          break;
+        case Key::PAGE_UP:
+          cursor = cursor > rows_ ? cursor - rows_ : 0;
+          break;
+        case Key::PAGE_DOWN:
+          cursor += rows_;
+          break;
+        case Key::ENTER: {
+          const std::vector<Match> &matches = filter(query);
+          if (matches.empty()) {
+            break;
+          }
+          sort(cursor + 1);
+          cursor = std::min(cursor, matches.size() - 1);
+          render(writer, query, cursor, false);
+          return options_[matches[cursor].index];
+        }
+        case Key::ESCAPE:
+        case Key::INTERRUPT:
+        case Key::END_OF_FILE:
+          render(writer, query, cursor, false);
+          return std::nullopt;
+        default:
+          break;
+        }
+      }
+    }
+  }
+  std::string pick(std::string_view line) {
+    std::size_t number = 0;
+    auto [end, ec] =
+        std::from_chars(line.data(), line.data() + line.size(), number);
+    if (ec == std::errc{} && end == line.data() + line.size() && number > 0 &&
+        number <= options_.size()) {
+      return options_[number - 1];
+    }
+    const std::vector<Match> &matches = filter(line);
+    if (matches.empty()) {
+      throw Exception(ExceptionType::IO,
+                      "no option matches " + std::string{line} + ".");
+    }
+    sort(1);
+    return options_[matches.front().index];
+  }
+  void render(Writer &writer, const std::string &query, std::size_t cursor,
+              bool selecting) {
+    std::size_t width = writer.width();
+    const std::vector<Match> &matches = history_.back();
+    lines_.resize(rows_ + 2);
+    lines_[0].assign(prompt_);
+    Writer::fit(lines_[0], query,
+                width > prompt_.size() ? width - prompt_.size() : 0);
+    for (std::size_t row = 0; row < rows_; row++) {
+      std::string &line = lines_[row + 1];
+      line.clear();
+      std::size_t index = top_ + row;
+      if (index < matches.size()) {
+        line.assign(index == cursor ? "> " : "  ");
+        Writer::fit(line, options_[matches[index].index],
+                    width > 2 ? width - 2 : 0);
+      }
+    }
+    lines_[rows_ + 1] = "  " + std::to_string(matches.size()) + "/" +
+                        std::to_string(options_.size());
+    writer.begin_frame();
+    if (selecting) {
+      writer.reset_cursor();
+    }
+    writer.out(lines_);
+    if (selecting) {
+      writer.move_column(std::min(lines_[0].size() + 1, width));
+    }
+    writer.end_frame();
+  }
+
+private:
+  std::string prompt_;
+  std::vector<std::string> options_;
+  str_callback_t callback_;
+  std::size_t rows_ = 10;
+  std::size_t top_ = 0;
+
+  std::string query_;
+  std::vector<std::vector<Match>> history_;
+  std::size_t sorted_ = 0;
+  std::vector<std::string> lines_;
+};
+
+} // namespace quikcli
+
+#endif // QC_SELECT_H_
@@ -0,0 +1,209 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+
+#ifndef QC_SESSION_H_
+#define QC_SESSION_H_
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "quikcli/exception.h"
+
+namespace quikcli {
+
+// The values that interactive components produced in one run, recorded so a
+// later run can replay them without a terminal. The file holds a 4 byte magic
+// followed by one record per component: its name and its value, each a
+// varint length and the bytes.
+class Session {
+public:
+  enum class Mode : uint8_t { RECORD, REPLAY };
+
+  /* Constructors & Destructors - No Copy Default Move */
+  Session(std::string path, Mode mode) : path_{std::move(path)}, mode_{mode} {
+    if (mode_ == Mode::REPLAY) {
+      load();
+    }
+  }
+
+  Session(Session &) = delete;
+  Session &operator=(Session &) = delete;
+  Session(Session &&) = default;
+  Session &operator=(Session &&) = default;
+
+public:
+  /* Getters */
+  const std::string &path() const { return path_; }
+  bool recording() const { return mode_ == Mode::RECORD; }
+  bool replaying() const { return mode_ == Mode::REPLAY; }
+
+  /* Recording */
+  void record(std::string_view component, std::string_view value) {
+    if (recording()) {
+      records_.emplace_back(component, value);
+    }
+  }
+  // Written to a temporary file that replaces path once complete, so that a
+  // failed save leaves an earlier recording intact.
+  void save() const {
+    std::string data{magic};
+    for (const auto &[component, value] : records_) {
+      append(data, component);
+      append(data, value);
+    }
+    std::string temporary = path_ + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      throw Exception(ExceptionType::IO, "failed to open " + temporary + ".");
+    }
+    std::string_view remaining = data;
+    while (!remaining.empty()) {
+      ssize_t written = write(fd, remaining.data(), remaining.size());
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        close(fd);
+        unlink(temporary.c_str());
+        throw Exception(ExceptionType::IO,
+                        "failed to write " + temporary + ".");
+      }
+      remaining.remove_prefix(written);
+    }
+    close(fd);
+    if (std::rename(temporary.c_str(), path_.c_str()) != 0) {
+      unlink(temporary.c_str());
+      throw Exception(ExceptionType::IO, "failed to replace " + path_ + ".");
+    }
+  }
+
+  /* Replaying */
+  // Returns the value recorded for the next component, which has to be the
+  // same kind of component as the one being run.
+  const std::string &next(std::string_view component) {
+    if (next_ == records_.size()) {
+      throw Exception(ExceptionType::IO, "session " + path_ +
+                                             " has no value left for " +
+                                             std::string{component} + ".");
+    }
+    const auto &[recorded, value] = records_[next_++];
+    if (recorded != component) {
+      throw Exception(ExceptionType::IO,
+                      "session " + path_ + " recorded " + recorded +
+                          " where " + std::string{component} + " was run.");
+    }
+    return value;
+  }
+
+private:
+  static constexpr std::string_view magic{"QCS\1"};
+
+  static void append(std::string &data, std::string_view str) {
+    uint64_t length = str.size();
+    while (length >= 0x80) {
+      data += static_cast<char>(length | 0x80);
+      length >>= 7;
+    }
+    data += static_cast<char>(length);
+    data += str;
+  }
+  static bool extract(std::string_view &data, std::string &str) {
+    uint64_t length = 0;
+    for (int shift = 0;; shift += 7) {
+      if (data.empty() || shift > 56) {
+        return false;
+      }
+      uint8_t byte = data.front();
+      data.remove_prefix(1);
+      length |= uint64_t{byte & 0x7Fu} << shift;
+      if (!(byte & 0x80)) {
+        break;
+      }
+    }
+    if (length > data.size()) {
+      return false;
+    }
+    str.assign(data.substr(0, length));
+    data.remove_prefix(length);
+    return true;
+  }
+  void load() {
+    int fd = open(path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw Exception(ExceptionType::IO, "failed to open " + path_ + ".");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+      close(fd);
+      throw Exception(ExceptionType::IO, "failed to stat " + path_ + ".");
+    }
+    std::string buffer(info.st_size, '\0');
+    std::size_t size = 0;
+    while (size < buffer.size()) {
+      ssize_t count = read(fd, buffer.data() + size, buffer.size() - size);
+      if (count < 0 && errno == EINTR) {
+        continue;
+      }
+      if (count <= 0) {
+        break;
+      }
+      size += count;
+    }
+    close(fd);
+    std::string_view data{buffer.data(), size};
+    if (!data.starts_with(magic)) {
+      throw Exception(ExceptionType::IO, path_ + " is not a session.");
+    }
+    data.remove_prefix(magic.size());
+    while (!data.empty()) {
+      std::pair<std::string, std::string> &record = records_.emplace_back();
+      if (!extract(data, record.first) || !extract(data, record.second)) {
+        throw Exception(ExceptionType::IO, path_ + " is truncated.");
+      }
+    }
+  }
+
+private:
+  std::string path_;
+  Mode mode_;
+  std::vector<std::pair<std::string, std::string>> records_;
+  std::size_t next_ = 0;
+};
+
+} // namespace quikcli
+
+#endif // QC_SESSION_H_
@@ -0,0 +1,388 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_STREAM_H_
+#define QC_STREAM_H_
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "quikcli/component.h"
+#include "quikcli/exception.h"
+#include "quikcli/terminal.h"
+#include "quikcli/writer.h"
+
+namespace quikcli {
+
+using line_generator_t = InplaceFunction<bool(std::string &)>;
+
+// Lines fetched on demand by StreamDisplay. A returned view stays valid until
+// the next call.
+class LineSource {
+public:
+  virtual ~LineSource() = default;
+
+  // Returns false if index is past the last line.
+  virtual bool line(std::size_t index, std::string_view &line) = 0;
+  // The first line still available; sources that discard old lines to bound
+  // their memory can no longer scroll back past it.
+  virtual std::size_t first_line() const { return 0; }
+};
+
+// A memory mapped file. Only the offset of every checkpoint_lines'th line is
+// indexed, and only as far as the viewport has been scrolled, so the index
+// stays small no matter how large the file is.
+class MappedFileSource : public LineSource {
+public:
+  static constexpr std::size_t checkpoint_lines = 1024;
+
+  /* Constructors & Destructors - No Copy No Move */
+  explicit MappedFileSource(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw Exception(ExceptionType::IO, "failed to open " + path + ".");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+      close(fd);
+      throw Exception(ExceptionType::IO, "failed to stat " + path + ".");
+    }
+    size_ = info.st_size;
+    if (size_ > 0) {
+      void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        close(fd);
+        throw Exception(ExceptionType::IO, "failed to map " + path + ".");
+      }
+      data_ = static_cast<const char *>(data);
+    }
+    close(fd);
+  }
+
+  MappedFileSource(MappedFileSource &) = delete;
+  MappedFileSource &operator=(MappedFileSource &) = delete;
+  MappedFileSource(MappedFileSource &&) = delete;
+  MappedFileSource &operator=(MappedFileSource &&) = delete;
+
+  ~MappedFileSource() override {
+    if (data_) {
+      munmap(const_cast<char *>(data_), size_);
+    }
+  }
+
+public:
+  bool line(std::size_t index, std::string_view &line) override {
+    std::size_t checkpoint = index / checkpoint_lines;
+    while (checkpoints_.size() <= checkpoint && !scanned_) {
+      scan_checkpoint();
+    }
+    if (checkpoints_.size() <= checkpoint) {
+      return false;
+    }
+    // continue from the last line served when scrolling forward nearby
+    if (!(cursor_line_ <= index &&
+          cursor_line_ / checkpoint_lines == checkpoint)) {
+      cursor_line_ = checkpoint * checkpoint_lines;
+      cursor_offset_ = checkpoints_[checkpoint];
+    }
+    while (cursor_line_ < index) {
+      if (cursor_offset_ >= size_) {
+        return false;
+      }
+      cursor_offset_ = next_line(cursor_offset_);
+      cursor_line_++;
+    }
+    if (cursor_offset_ >= size_) {
+      return false;
+    }
+    std::size_t end = next_line(cursor_offset_);
+    line = std::string_view{data_ + cursor_offset_, end - cursor_offset_};
+    if (line.ends_with('\n')) {
+      line.remove_suffix(1);
+    }
+    if (line.ends_with('\r')) {
+      line.remove_suffix(1);
+    }
+    return true;
+  }
+
+private:
+  std::size_t next_line(std::size_t offset) const {
+    const void *newline = std::memchr(data_ + offset, '\n', size_ - offset);
+    return newline ? static_cast<const char *>(newline) - data_ + 1 : size_;
+  }
+  void scan_checkpoint() {
+    if (checkpoints_.empty()) {
+      checkpoints_.push_back(0);
+      scanned_ = size_ == 0;
+      return;
+    }
+    std::size_t offset = checkpoints_.back();
+    for (std::size_t i = 0; i < checkpoint_lines && offset < size_; i++) {
+      offset = next_line(offset);
+    }
+    if (offset < size_) {
+      checkpoints_.push_back(offset);
+    } else {
+      scanned_ = true;
+    }
+  }
+
+private:
+  const char *data_ = nullptr;
+  std::size_t size_ = 0;
+  std::vector<std::size_t> checkpoints_;
+  bool scanned_ = false;
+  std::size_t cursor_line_ = 0;
+  std::size_t cursor_offset_ = 0;
+};
+
+// Lines pulled from a generator, which returns false once it has no more. The
+// most recent capacity lines are kept for scrolling back.
+class GeneratorSource : public LineSource {
+public:
+  explicit GeneratorSource(line_generator_t generator,
+                           std::size_t capacity = 4096)
+      : generator_{std::move(generator)}, capacity_{capacity} {}
+
+public:
+  bool line(std::size_t index, std::string_view &line) override {
+    while (!done_ && index >= first_ + lines_.size()) {
+      std::string next;
+      if (!generator_(next)) {
+        done_ = true;
+        break;
+      }
+      lines_.push_back(std::move(next));
+      if (lines_.size() > capacity_) {
+        lines_.pop_front();
+        first_++;
+      }
+    }
+    if (index < first_ || index >= first_ + lines_.size()) {
+      return false;
+    }
+    line = lines_[index - first_];
+    return true;
+  }
+  std::size_t first_line() const override { return first_; }
+
+private:
+  line_generator_t generator_;
+  std::size_t capacity_;
+  std::deque<std::string> lines_;
+  std::size_t first_ = 0;
+  bool done_ = false;
+};
+
+// Shows a LineSource of any size. On a terminal only the visible viewport is
+// fetched and drawn, and it can be scrolled with the arrow, page, home and end
+// keys (or j/k, space/b, g/G) until q is pressed. Otherwise every line is
+// streamed through in fixed size chunks.
+class StreamDisplay : public Component {
+public:
+  static constexpr std::size_t chunk_lines = 256;
+
+  /* Constructors & Destructors - No Copy Default Move */
+  StreamDisplay(std::unique_ptr<LineSource> source)
+      : StreamDisplay(std::move(source), [] {}) {}
+  StreamDisplay(std::unique_ptr<LineSource> source, empty_callback_t callback)
+      : source_{std::move(source)}, callback_{std::move(callback)} {}
+
+  StreamDisplay(StreamDisplay &) = delete;
+  StreamDisplay &operator=(StreamDisplay &) = delete;
+  StreamDisplay(StreamDisplay &&) = default;
+  StreamDisplay &operator=(StreamDisplay &&) = default;
+
+public:
+  void run(Writer &writer) override {
+    std::optional<RawMode> raw_mode;
+    if (is_interactive(writer.fd())) {
+      raw_mode.emplace();
+    }
+    if (raw_mode && raw_mode->active()) {
+      page(writer);
+    } else {
+      stream(writer);
+    }
+    auto span = writer.trace("StreamDisplay callback");
+    callback_();
+  }
+  const char *name() const override { return "StreamDisplay"; }
+
+private:
+  void stream(Writer &writer) {
+    std::vector<std::string> outputs(chunk_lines);
+    std::size_t count = 0;
+    std::string_view line;
+    for (std::size_t index = 0; source_->line(index, line); index++) {
+      outputs[count++].assign(line);
+      if (count == chunk_lines) {
+        writer.out(outputs);
+        count = 0;
+      }
+    }
+    if (count > 0) {
+      outputs.resize(count);
+      writer.out(outputs);
+    }
+  }
+  void page(Writer &writer) {
+    std::vector<std::string> outputs;
+    std::vector<KeyEvent> events;
+    KeyReader reader;
+    std::size_t top = 0;
+    bool quit = false;
+    while (true) {
+      // one row is left free for the newline after the block
+      std::size_t rows = writer.height() > 3 ? writer.height() - 2 : 1;
+      std::size_t width = writer.width();
+      outputs.resize(rows + 1);
+      draw(outputs, top, rows, width);
+      writer.reset_cursor();
+      writer.out(outputs);
+      if (quit || !reader.read(events)) {
+        break;
+      }
+      for (const KeyEvent &event : events) {
+        std::size_t last = top + rows - 1;
+        switch (event.key) {
+        case Key::UP:
+          top = top > 0 ? top - 1 : 0;
+          break;
+        case Key::DOWN:
+        case Key::ENTER:
+          top += has_line(last + 1);
+          break;
+        case Key::PAGE_UP:
+          top = top > rows ? top - rows : 0;
+          break;
+        case Key::PAGE_DOWN:
+          top += has_line(last + 1) ? rows : 0;
+          break;
+        case Key::HOME:
+          top = 0;
+          break;
+        case Key::END:
+          top = last_page(top, rows);
+          break;
+        case Key::ESCAPE:
+        case Key::INTERRUPT:
+        case Key::END_OF_FILE:
+          quit = true;
+          break;
+        case Key::CHAR:
+          switch (event.ch) {
+          case 'k':
+            top = top > 0 ? top - 1 : 0;
+            break;
+          case 'j':
+            top += has_line(last + 1);
+            break;
+          case 'b':
+            top = top > rows ? top - rows : 0;
+            break;
+          case ' ':
+          case 'f':
+            top += has_line(last + 1) ? rows : 0;
+            break;
+          case 'g':
+            top = 0;
+            break;
+          case 'G':
+            top = last_page(top, rows);
+            break;
+          case 'q':
+            quit = true;
+            break;
+          }
+          break;
+        default:
+          break;
+        }
+        top = std::max(top, source_->first_line());
+      }
+    }
+    writer.newline();
+  }
+  void draw(std::vector<std::string> &outputs, std::size_t top,
+            std::size_t rows, std::size_t width) {
+    std::string_view line;
+    std::size_t shown = 0;
+    for (std::size_t row = 0; row < rows; row++) {
+      outputs[row].clear();
+      if (source_->line(top + row, line)) {
+        Writer::fit(outputs[row], line, width);
+        shown++;
+      }
+    }
+    std::string &status = outputs[rows];
+    status = "lines " + std::to_string(top + 1) + "-" +
+             std::to_string(top + shown) +
+             (has_line(top + rows) ? "" : " (end)") + "  q to quit";
+    if (status.size() > width) {
+      status.resize(width);
+    }
+  }
+  bool has_line(std::size_t index) {
+    std::string_view line;
+    return source_->line(index, line);
+  }
+  // Finds the top of the last page by galloping ahead, then bisecting.
+  std::size_t last_page(std::size_t top, std::size_t rows) {
+    std::size_t low = top;
+    std::size_t step = rows;
+    while (has_line(low + step)) {
+      low += step;
+      step *= 2;
+    }
+    std::size_t high = low + step;
+    while (high - low > 1) {
+      std::size_t mid = low + (high - low) / 2;
+      (has_line(mid) ? low : high) = mid;
+    }
+    return low + 1 > rows ? low + 1 - rows : 0;
+  }
+private:
+  std::unique_ptr<LineSource> source_;
+  empty_callback_t callback_;
+};
+
+} // namespace quikcli
+
+#endif // QC_STREAM_H_
@@ -0,0 +1,260 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_TERMINAL_H_
+#define QC_TERMINAL_H_
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "constants.h"
+
+namespace quikcli {
+
+enum class Key : uint8_t {
+  CHAR = 0,
+  ENTER,
+  TAB,
+  BACKSPACE,
+  DELETE,
+  ESCAPE,
+  UP,
+  DOWN,
+  LEFT,
+  RIGHT,
+  HOME,
+  END,
+  PAGE_UP,
+  PAGE_DOWN,
+  INTERRUPT,
+  END_OF_FILE,
+  CONTROL,
+};
+
+struct KeyEvent {
+  Key key;
+  char ch = '\0';
+};
+
+// Whether keys can be read from stdin and drawn to fd. Raw mode is only worth
+// entering when both are terminals; otherwise input is read a line at a time
+// and has to keep its echo, line editing and signals.
+inline bool is_interactive(int fd) {
+  return isatty(STDIN_FILENO) && isatty(fd);
+}
+
+// Puts a terminal into raw mode for the lifetime of the object. Does nothing
+// when fd is not a terminal.
+class RawMode {
+public:
+  /* Constructors & Destructors - No Copy No Move */
+  explicit RawMode(int fd = STDIN_FILENO) : fd_{fd} {
+    active_ = isatty(fd_) && tcgetattr(fd_, &saved_) == 0;
+    if (!active_) {
+      return;
+    }
+    termios raw = saved_;
+    raw.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+    raw.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+    raw.c_cflag |= CS8;
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    active_ = tcsetattr(fd_, TCSANOW, &raw) == 0;
+  }
+
+  RawMode(RawMode &) = delete;
+  RawMode &operator=(RawMode &) = delete;
+  RawMode(RawMode &&) = delete;
+  RawMode &operator=(RawMode &&) = delete;
+
+  ~RawMode() {
+    if (active_) {
+      tcsetattr(fd_, TCSANOW, &saved_);
+    }
+  }
+
+public:
+  bool active() const { return active_; }
+
+private:
+  int fd_;
+  bool active_ = false;
+  termios saved_;
+};
+
+// Decodes keystrokes from a raw mode terminal. Each call to read() decodes
+// everything a single read(2) returned, so a burst of input such as a paste
+// is handled in one pass. An escape sequence cut short, e.g. by a
+// slow link, is held over until the rest arrives; only an ESC followed by
+// nothing for KeyReaderDefaults::escape_timeout_ms is reported as a key.
+class KeyReader {
+public:
+  explicit KeyReader(int fd = STDIN_FILENO) : fd_{fd} {}
+
+public:
+  // Blocks until input is available. Returns false once the input is closed.
+  // A signal such as a resize returns early with no events, so that the
+  // caller can redraw.
+  bool read(std::vector<KeyEvent> &events) {
+    events.clear();
+    do {
+      // poll is never restarted after a signal handler, unlike read
+      pollfd request{fd_, POLLIN, 0};
+      int timeout =
+          pending_.empty() ? -1 : KeyReaderDefaults::escape_timeout_ms;
+      int ready = ::poll(&request, 1, timeout);
+      if (ready < 0) {
+        return errno == EINTR;
+      }
+      if (ready == 0) {
+        pending_.clear();
+        events.push_back({Key::ESCAPE});
+        return true;
+      }
+      char buffer[4096];
+      std::size_t carried = pending_.size();
+      pending_.copy(buffer, carried);
+      pending_.clear();
+      ssize_t count;
+      do {
+        count = ::read(fd_, buffer + carried, sizeof(buffer) - carried);
+      } while (count < 0 && errno == EINTR);
+      if (count <= 0) {
+        return false;
+      }
+      decode(std::string_view{buffer, carried + count}, events);
+      // a sequence held over on its own is waited on here, not by the caller
+    } while (events.empty() && !pending_.empty());
+    return true;
+  }
+
+private:
+  void decode(std::string_view input, std::vector<KeyEvent> &events) {
+    for (std::size_t i = 0; i < input.size(); i++) {
+      unsigned char c = input[i];
+      if (c == '\033') {
+        std::size_t length = escape_length(input.substr(i));
+        if (length == 0) {
+          if (input.size() - i < KeyReaderDefaults::max_escape) {
+            pending_.assign(input.substr(i));
+            return;
+          }
+          length = 1;
+        }
+        events.push_back(decode_escape(input.substr(i, length)));
+        i += length - 1;
+      } else if (c == '\r' || c == '\n') {
+        events.push_back({Key::ENTER});
+      } else if (c == '\t') {
+        events.push_back({Key::TAB});
+      } else if (c == 0x7f || c == 0x08) {
+        events.push_back({Key::BACKSPACE});
+      } else if (c == 0x03) {
+        events.push_back({Key::INTERRUPT});
+      } else if (c == 0x04) {
+        events.push_back({Key::END_OF_FILE});
+      } else if (c < 0x20) {
+        events.push_back({Key::CONTROL, static_cast<char>(c + '@')});
+      } else {
+        events.push_back({Key::CHAR, static_cast<char>(c)});
+      }
+    }
+  }
+  // Length of the CSI or SS3 sequence at the start of input, or 0 if it is
+  // incomplete.
+  static std::size_t escape_length(std::string_view input) {
+    if (input.size() < 2) {
+      return 0;
+    }
+    if (input[1] == 'O') {
+      return input.size() >= 3 ? 3 : 0;
+    }
+    if (input[1] != '[') {
+      return 1;
+    }
+    for (std::size_t i = 2; i < input.size(); i++) {
+      if (input[i] >= 0x40 && input[i] <= 0x7e) {
+        return i + 1;
+      }
+    }
+    return 0;
+  }
+  static KeyEvent decode_escape(std::string_view sequence) {
+    if (sequence.size() < 3) {
+      return {Key::ESCAPE};
+    }
+    switch (sequence.back()) {
+    case 'A':
+      return {Key::UP};
+    case 'B':
+      return {Key::DOWN};
+    case 'C':
+      return {Key::RIGHT};
+    case 'D':
+      return {Key::LEFT};
+    case 'H':
+      return {Key::HOME};
+    case 'F':
+      return {Key::END};
+    case '~': {
+      std::string_view code = sequence.substr(2, sequence.size() - 3);
+      if (code == "1" || code == "7") {
+        return {Key::HOME};
+      }
+      if (code == "4" || code == "8") {
+        return {Key::END};
+      }
+      if (code == "3") {
+        return {Key::DELETE};
+      }
+      if (code == "5") {
+        return {Key::PAGE_UP};
+      }
+      if (code == "6") {
+        return {Key::PAGE_DOWN};
+      }
+      return {Key::ESCAPE};
+    }
+    default:
+      return {Key::ESCAPE};
+    }
+  }
+
+private:
+  int fd_;
+  std::string pending_;
+};
+
+} // namespace quikcli
+
+#endif // QC_TERMINAL_H_
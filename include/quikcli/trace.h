@@ -0,0 +1,194 @@
+/* --------------------------------------------------------------------------------
+ * QuikCli - an interactive command line interface builder
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 Yiyun Jia
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * --------------------------------------------------------------------------------
+ */
+
+#ifndef QC_TRACE_H_
+#define QC_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace quikcli {
+
+struct TraceEvent {
+  const char *name;
+  const char *category;
+  std::chrono::nanoseconds start;
+  std::chrono::nanoseconds duration;
+  uint32_t thread;
+  uint64_t bytes = 0;
+  uint64_t redraws = 0;
+};
+
+// Records timed spans while enabled; disabled tracers cost a branch per span.
+// Names are not copied and must outlive the tracer.
+class Tracer {
+private:
+  using clock = std::chrono::steady_clock;
+  using clock_time = clock::time_point;
+
+public:
+  class Span {
+  public:
+    Span(Tracer *tracer, const char *name, const char *category)
+        : tracer_{tracer && tracer->enabled() ? tracer : nullptr},
+          name_{name}, category_{category} {
+      if (tracer_) {
+        start_ = clock::now();
+      }
+    }
+    ~Span() {
+      if (tracer_) {
+        tracer_->record({name_, category_, start_ - tracer_->epoch_,
+                         clock::now() - start_, thread_index(), bytes_,
+                         redraws_});
+      }
+    }
+
+    Span(Span &) = delete;
+    Span &operator=(Span &) = delete;
+    Span(Span &&) = delete;
+    Span &operator=(Span &&) = delete;
+
+    bool active() const { return tracer_ != nullptr; }
+    void set_output(uint64_t bytes, uint64_t redraws) {
+      bytes_ = bytes;
+      redraws_ = redraws;
+    }
+
+  private:
+    Tracer *tracer_;
+    const char *name_;
+    const char *category_;
+    clock_time start_;
+    uint64_t bytes_ = 0;
+    uint64_t redraws_ = 0;
+  };
+
+public:
+  /* Constructors & Destructors - No Copy Default Move */
+  Tracer() = default;
+
+  Tracer(Tracer &) = delete;
+  Tracer &operator=(Tracer &) = delete;
+  Tracer(Tracer &&other) noexcept
+      : enabled_{other.enabled_}, epoch_{other.epoch_},
+        events_{std::move(other.events_)} {}
+  Tracer &operator=(Tracer &&other) noexcept {
+    enabled_ = other.enabled_;
+    epoch_ = other.epoch_;
+    events_ = std::move(other.events_);
+    return *this;
+  }
+
+public:
+  /* Getters & Setters */
+  bool enabled() const { return enabled_; }
+  const std::vector<TraceEvent> &events() const { return events_; }
+  void enable() {
+    if (!enabled_) {
+      epoch_ = clock::now();
+      events_.clear();
+    }
+    enabled_ = true;
+  }
+  void disable() { enabled_ = false; }
+
+  /* Recording */
+  Span span(const char *name, const char *category) {
+    return Span{this, name, category};
+  }
+  // Spans may end on several threads at once, e.g. flag callbacks run by a
+  // WorkPool.
+  void record(TraceEvent event) {
+    std::lock_guard lock{mutex_};
+    events_.push_back(event);
+  }
+
+  /* Export */
+  // Writes the Chrome trace-event format, loadable by chrome://tracing or
+  // https://ui.perfetto.dev.
+  void write_chrome_trace(std::ostream &out) const {
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (std::size_t i = 0; i < events_.size(); i++) {
+      const TraceEvent &event = events_[i];
+      out << (i ? ",\n" : "\n") << "{\"name\":";
+      write_string(out, event.name);
+      out << ",\"cat\":";
+      write_string(out, event.category);
+      out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+          << ",\"ts\":";
+      write_micros(out, event.start);
+      out << ",\"dur\":";
+      write_micros(out, event.duration);
+      out << ",\"args\":{\"bytes\":" << event.bytes
+          << ",\"redraws\":" << event.redraws << "}}";
+    }
+    out << "\n]}\n";
+  }
+
+private:
+  static uint32_t thread_index() {
+    static std::atomic<uint32_t> next_index = 1;
+    thread_local uint32_t index = next_index++;
+    return index;
+  }
+  static void write_micros(std::ostream &out, std::chrono::nanoseconds time) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", time.count() / 1000.0);
+    out << buffer;
+  }
+  static void write_string(std::ostream &out, std::string_view str) {
+    out << '"';
+    for (char c : str) {
+      if (c == '"' || c == '\\') {
+        out << '\\' << c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        out << ' ';
+      } else {
+        out << c;
+      }
+    }
+    out << '"';
+  }
+
+private:
+  bool enabled_ = false;
+  clock_time epoch_;
+  std::vector<TraceEvent> events_;
+  std::mutex mutex_;
+};
+
+} // namespace quikcli
+
+#endif // QC_TRACE_H_
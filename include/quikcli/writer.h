@@ -28,18 +28,104 @@
 #ifndef QC_WRITER_H_
 #define QC_WRITER_H_
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 #include <sys/ioctl.h>
 #include <unistd.h>
 
+#include "quikcli/log.h"
+#include "quikcli/render.h"
+#include "quikcli/session.h"
+#include "quikcli/trace.h"
+
 namespace quikcli {
 
+struct WriterStats {
+  uint64_t bytes = 0;
+  uint64_t syscalls = 0;
+  uint64_t frames = 0;
+};
+
+// Decides which progress updates are reported in structured mode: a change of
+// at least step, or any change once interval has passed since the last report.
+// Completion is always reported.
+class ProgressThrottle {
+public:
+  ProgressThrottle(double step, std::chrono::nanoseconds interval)
+      : step_{step}, interval_{interval} {}
+
+public:
+  bool pass(double progress) {
+    if (progress == reported_) {
+      return false;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (progress < 1.0 && progress - reported_ < step_ &&
+        now - reported_at_ < interval_) {
+      return false;
+    }
+    reported_ = progress;
+    reported_at_ = now;
+    return true;
+  }
+
+private:
+  double step_;
+  std::chrono::nanoseconds interval_;
+  double reported_ = -1;
+  std::chrono::steady_clock::time_point reported_at_;
+};
+
+// Lets a render loop sleep until another thread has something for it, such as
+// a progress update or a log line. Read epoch() before looking at that state
+// and wait() on it after, so that a notify() in between is not missed.
+class Wake {
+public:
+  uint32_t epoch() const { return epoch_.load(std::memory_order_acquire); }
+  void wait(uint32_t epoch) const {
+    epoch_.wait(epoch, std::memory_order_acquire);
+  }
+  void notify() {
+    epoch_.fetch_add(1, std::memory_order_release);
+    epoch_.notify_all();
+  }
+
+private:
+  std::atomic<uint32_t> epoch_ = 0;
+};
+
+// Keeps track of the terminal size. A SIGWINCH handler only counts resizes;
+// the size is queried again on the next frame after one, so layouts that read
+// width() and height() per frame reflow without polling the terminal.
 class Writer {
 public:
-  Writer() { init(); }
+  static constexpr unsigned short default_width = 80;
+  static constexpr unsigned short default_height = 24;
+
+  Writer() : Writer(STDOUT_FILENO) {}
+  explicit Writer(int fd) : fd_{fd} { init(); }
+  ~Writer() {
+    stop_rendering();
+    if (channel_) {
+      flush_logs();
+      release_logs();
+    }
+  }
 
   Writer(Writer &) = delete;
   Writer &operator=(Writer &) = delete;
@@ -48,44 +134,800 @@ public:
 
 public:
   /* Getters & Setters */
-  int width() { return width_; }
+  int width() {
+    if (render_) {
+      return render_size() >> 16;
+    }
+    update_size();
+    return width_;
+  }
+  int height() {
+    if (render_) {
+      return render_size() & 0xFFFF;
+    }
+    update_size();
+    return height_;
+  }
+  int fd() const { return fd_; }
+  WriterStats frame_stats() const {
+    std::unique_lock lock = lock_stats();
+    return frame_stats_;
+  }
+  WriterStats total_stats() const {
+    std::unique_lock lock = lock_stats();
+    return total_stats_;
+  }
   Writer &reset_cursor() {
-    reset_cursor_ = true;
+    if (render_) {
+      render_->retain = true;
+    } else {
+      reset_cursor_ = true;
+    }
+    return *this;
+  }
+  void set_tracer(Tracer *tracer) { tracer_ = tracer; }
+  // Where interactive components record their values, or take them from.
+  Session *session() const { return session_; }
+  void set_session(Session *session) { session_ = session; }
+
+  /* Headless Output */
+  // Nothing is written, logs included, and components skip their layout and
+  // frame pacing altogether, e.g. while replaying a session in a batch run.
+  bool headless() const { return headless_; }
+  Writer &set_headless(bool headless) {
+    if (headless) {
+      stop_rendering();
+    }
+    headless_ = headless;
+    return *this;
+  }
+
+  /* Structured Output */
+  // Off a terminal, output is written as JSON lines of events rather than
+  // drawn, and components report throttled progress instead of redrawing:
+  //
+  //   {"event":"begin","component":"Loader"}
+  //   {"event":"progress","name":"Loader","progress":0.250}
+  //   {"event":"output","text":"Welcome!"}
+  //   {"event":"end","component":"Loader"}
+  bool structured() const { return structured_; }
+  Writer &set_structured(bool structured) {
+    if (structured) {
+      stop_rendering();
+    }
+    structured_ = structured;
     return *this;
   }
+  Writer &set_progress_step(double step) {
+    progress_step_ = step;
+    return *this;
+  }
+  Writer &set_progress_interval(std::chrono::nanoseconds interval) {
+    progress_interval_ = interval;
+    return *this;
+  }
+  ProgressThrottle progress_throttle() const {
+    return ProgressThrottle{progress_step_, progress_interval_};
+  }
+  void begin_component(std::string_view name) {
+    channel_->drawing.store(this);
+    flush_logs();
+    component_event("begin", name);
+  }
+  void end_component(std::string_view name) {
+    flush_logs();
+    component_event("end", name);
+    sync();
+    release_logs();
+  }
+  void progress(std::string_view name, double progress) {
+    if (!structured_ || headless_) {
+      return;
+    }
+    char value[32];
+    std::snprintf(value, sizeof(value), "%.3f", progress);
+    buffer_ += "{\"event\":\"progress\",\"name\":";
+    append_string(name);
+    buffer_ += ",\"progress\":";
+    buffer_ += value;
+    buffer_ += "}\n";
+    flush();
+  }
+
+  /* Logging */
+  // Queues a line to be printed above the live region in the next frame, or
+  // by flush_logs(). Safe to call from any thread, and never waits on the
+  // terminal.
+  void log(std::string line) {
+    channel_->logs.push(std::move(line));
+    channel_->wake.notify();
+  }
+  // Notified by log(); render loops may wait on it for their own updates too.
+  Wake &wake() { return channel_->wake; }
+  // Shares other's queue and wake, so that lines logged to either are printed
+  // by whichever of the two is drawing, e.g. a subcommand's writer.
+  void share_logs(const Writer &other) { channel_ = other.channel_; }
+  // Prints the queued lines now, redrawing a retained region below them. A
+  // render thread prints them itself with each frame.
+  void flush_logs() {
+    if (!render_) {
+      draw_logs();
+    }
+  }
+
+  /* Render Thread */
+  // Hands drawing to a thread of its own that commits a frame frame_rate
+  // times a second, so that a slow terminal never holds up the calling thread.
+  // A retained block is published as a snapshot, of which the thread draws the
+  // latest; other output is queued and drawn in order. A rate of 0 draws on
+  // the calling thread again. Structured output is always written directly.
+  // The writer must not be moved while a render thread is running.
+  Writer &set_render_rate(uint32_t frame_rate) {
+    stop_rendering();
+    if (frame_rate > 0 && !structured_ && !headless_) {
+      start_rendering(std::chrono::nanoseconds{std::chrono::seconds{1}} /
+                      frame_rate);
+    }
+    return *this;
+  }
+  bool rendering() const { return render_ != nullptr; }
+  // Waits until everything output so far has been committed by the render
+  // thread, e.g. before writing to the terminal by other means.
+  void sync() {
+    if (!render_) {
+      return;
+    }
+    Renderer &render = *render_;
+    std::unique_lock lock{render.mutex};
+    render.sync_to = render.seq;
+    render.tick.notify_one();
+    channel_->wake.notify();
+    render.synced.wait(lock, [&] { return render.flushed >= render.sync_to; });
+  }
+
+  /* Tracing */
+  // Times a user callback invoked by a component while rendering.
+  Tracer::Span trace(const char *name) {
+    return Tracer::Span{tracer_, name, "callback"};
+  }
+
+  /* Layout */
+  // Appends line to output, expanding tabs, masking control characters and
+  // cutting it off at width cells so that it takes up exactly one row.
+  static void fit(std::string &output, std::string_view line,
+                  std::size_t width) {
+    std::size_t cells = 0;
+    for (char c : line) {
+      if (cells >= width) {
+        break;
+      }
+      if (c == '\t') {
+        std::size_t stop = std::min(width, (cells / 8 + 1) * 8);
+        output.append(stop - cells, ' ');
+        cells = stop;
+      } else if (static_cast<unsigned char>(c) < 0x20 || c == 0x7f) {
+        output += '?';
+        cells++;
+      } else {
+        output += c;
+        // utf-8 continuation bytes share the cell of their lead byte
+        cells += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+      }
+    }
+  }
+
+  /* Frames */
+  // Output between begin_frame() and end_frame() is buffered and committed to
+  // the terminal with a single write. Outside of a frame, each call to out()
+  // or newline() is its own frame.
+  Writer &begin_frame() {
+    if (render_) {
+      render_->depth++;
+    } else {
+      frame_depth_++;
+    }
+    return *this;
+  }
+  void end_frame() {
+    if (render_) {
+      if (render_->depth > 0 && --render_->depth == 0 && render_->dirty) {
+        publish_region();
+      }
+    } else if (frame_depth_ > 0 && --frame_depth_ == 0) {
+      commit();
+    }
+  }
 
   /* Runtime */
-  void newline() { std::cout << std::endl; }
-  void out(std::string &output) {
-    std::cout << output << std::endl;
-    if (reset_cursor_) {
-      std::cout << "\033[1A";
+  void newline() {
+    if (structured_ || headless_) {
+      return;
     }
-    std::cout.flush();
-    reset();
+    if (render_) {
+      Renderer &render = *render_;
+      // carries the block's last state, as its snapshot may not be drawn
+      submit(Op::Kind::NEWLINE,
+             render.live ? std::span<const std::string>{render.last}
+                         : std::span<const std::string>{},
+             render.column);
+      render.live = false;
+      render.dirty = false;
+      return;
+    }
+    step_past();
   }
-  void out(std::vector<std::string> &outputs) {
-    for (std::string &output : outputs) {
-      std::cout << output << std::endl;
+  // Moves the cursor to a (1-based) column of the current row, e.g. to show
+  // the edit position inside a retained block.
+  void move_column(std::size_t column) {
+    if (structured_ || headless_) {
+      return;
     }
-    if (reset_cursor_) {
-      std::cout << "\033[" + std::to_string(outputs.size()) + "A";
+    if (render_) {
+      render_->column = column;
+      if (render_->live) {
+        publish_region();
+      }
+      return;
+    }
+    csi(column, 'G');
+    flush();
+  }
+  void out(const std::string &output) {
+    out(std::span<const std::string>{&output, 1});
+  }
+  void out(const std::vector<std::string> &outputs) {
+    out(std::span<const std::string>{outputs});
+  }
+  void out(std::span<const std::string> lines) {
+    if (!render_) {
+      paint(lines);
+      return;
+    }
+    Renderer &render = *render_;
+    if (render.retain) {
+      render.retain = false;
+      render.live = true;
+      render.last.assign(lines.begin(), lines.end());
+      render.column = 0;
+      publish_region();
+    } else {
+      render.live = false;
+      render.dirty = false;
+      submit(Op::Kind::OUT, lines, 0);
     }
-    std::cout.flush();
-    reset();
   }
 
 private:
   void init() {
-    winsize w;
-    ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
-    width_ = w.ws_col;
+    if (query_size()) {
+      install_resize_handler();
+    } else {
+      structured_ = true;
+    }
+    seen_resizes_ = resizes_.load(std::memory_order_relaxed);
+  }
+  // Falls back to the default size if fd_ is not a terminal or reports an
+  // empty size. Returns false in the former case.
+  bool query_size() {
+    winsize w{};
+    bool terminal = ioctl(fd_, TIOCGWINSZ, &w) == 0;
+    width_ = terminal && w.ws_col > 0 ? w.ws_col : default_width;
+    height_ = terminal && w.ws_row > 0 ? w.ws_row : default_height;
+    return terminal;
+  }
+  void update_size() {
+    uint32_t resizes = resizes_.load(std::memory_order_relaxed);
+    if (resizes == seen_resizes_) {
+      return;
+    }
+    seen_resizes_ = resizes;
+    unsigned short width = width_;
+    unsigned short height = height_;
+    query_size();
+    // the terminal may have rewrapped the retained block
+    stale_ = stale_ || width != width_ || height != height_;
+  }
+  static void install_resize_handler() {
+    static const bool installed = [] {
+      struct sigaction action{};
+      action.sa_handler = [](int signal) {
+        resizes_.fetch_add(1, std::memory_order_relaxed);
+        if (previous_handler_ != SIG_DFL && previous_handler_ != SIG_IGN) {
+          previous_handler_(signal);
+        }
+      };
+      sigemptyset(&action.sa_mask);
+      action.sa_flags = SA_RESTART;
+      struct sigaction previous{};
+      sigaction(SIGWINCH, &action, &previous);
+      if (!(previous.sa_flags & SA_SIGINFO)) {
+        previous_handler_ = previous.sa_handler;
+      }
+      return true;
+    }();
+    (void)installed;
+  }
+  void step_past() {
+    // a retained block leaves the cursor on its first row, so step past it
+    std::size_t rows = retained_ ? screen_.size() : 1;
+    if (retained_) {
+      buffer_ += '\r';
+    }
+    buffer_.append(rows, '\n');
+    release();
+    print_logs();
+    flush();
+  }
+  void draw_logs() {
+    if (channel_->logs.empty()) {
+      return;
+    }
+    if (retained_) {
+      // paint() releases screen_ before it is done with the lines
+      std::vector<std::string> screen;
+      screen.swap(screen_);
+      reset_cursor_ = true;
+      paint(screen);
+    } else {
+      print_logs();
+      flush();
+    }
   }
   void reset() { reset_cursor_ = false; }
+  void release() {
+    retained_ = false;
+    screen_.clear();
+  }
+
+  /* Rendering */
+  // A block written with reset_cursor() is retained so that the next block of
+  // the same height only sends the cell spans that changed since.
+  void paint(std::span<const std::string> lines) {
+    if (headless_) {
+      print_logs();
+      reset();
+      return;
+    }
+    if (structured_) {
+      print_logs();
+      for (const std::string &line : lines) {
+        buffer_ += "{\"event\":\"output\",\"text\":";
+        append_string(line);
+        buffer_ += "}\n";
+      }
+      reset();
+      flush();
+      return;
+    }
+    update_size();
+    if (!channel_->logs.empty()) {
+      // the logs take the region's place and it is drawn again below them
+      if (retained_) {
+        buffer_ += "\r\033[J";
+      }
+      print_logs();
+      release();
+    }
+    if (retained_ && !stale_ && screen_.size() == lines.size()) {
+      paint_diff(lines);
+    } else {
+      paint_full(lines);
+    }
+    if (reset_cursor_ && !lines.empty()) {
+      retained_ = true;
+      screen_.resize(lines.size());
+      for (std::size_t i = 0; i < lines.size(); i++) {
+        screen_[i] = lines[i];
+      }
+    } else {
+      release();
+    }
+    stale_ = false;
+    reset();
+    flush();
+  }
+  void paint_full(std::span<const std::string> lines) {
+    if (retained_) {
+      buffer_ += "\r\033[J";
+    }
+    for (const std::string &line : lines) {
+      buffer_ += line;
+      buffer_ += '\n';
+    }
+    if (reset_cursor_ && !lines.empty()) {
+      csi(lines.size(), 'A');
+    }
+  }
+  void paint_diff(std::span<const std::string> lines) {
+    std::size_t row = 0;
+    bool dirty = false;
+    for (std::size_t i = 0; i < lines.size(); i++) {
+      const std::string &prev = screen_[i];
+      const std::string &next = lines[i];
+      if (prev == next) {
+        continue;
+      }
+      dirty = true;
+      std::size_t begin = 0;
+      std::size_t end = next.size();
+      bool clear = true;
+      if (is_plain(prev) && is_plain(next)) {
+        std::size_t common = std::min(prev.size(), next.size());
+        while (begin < common && prev[begin] == next[begin]) {
+          begin++;
+        }
+        clear = next.size() < prev.size();
+        if (next.size() == prev.size()) {
+          while (end > begin && prev[end - 1] == next[end - 1]) {
+            end--;
+          }
+        }
+      }
+      if (i > row) {
+        csi(i - row, 'B');
+        row = i;
+      }
+      csi(begin + 1, 'G');
+      buffer_.append(next, begin, end - begin);
+      if (clear) {
+        buffer_ += "\033[K";
+      }
+    }
+    if (reset_cursor_) {
+      if (!dirty) {
+        return;
+      }
+      if (row > 0) {
+        csi(row, 'A');
+      }
+    } else {
+      csi(lines.size() - row, 'B');
+    }
+    buffer_ += '\r';
+  }
+  bool print_logs() {
+    return channel_->logs.drain([&](const std::string &line) {
+      if (headless_) {
+        return;
+      }
+      if (structured_) {
+        buffer_ += "{\"event\":\"log\",\"text\":";
+        append_string(line);
+        buffer_ += "}\n";
+      } else {
+        buffer_ += line;
+        buffer_ += '\n';
+      }
+    });
+  }
+  void component_event(const char *event, std::string_view name) {
+    if (!structured_ || headless_) {
+      return;
+    }
+    buffer_ += "{\"event\":\"";
+    buffer_ += event;
+    buffer_ += "\",\"component\":";
+    append_string(name);
+    buffer_ += "}\n";
+    flush();
+  }
+  void append_string(std::string_view str) {
+    buffer_ += '"';
+    for (char c : str) {
+      if (c == '"' || c == '\\') {
+        buffer_ += '\\';
+        buffer_ += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[8];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        buffer_ += escaped;
+      } else {
+        buffer_ += c;
+      }
+    }
+    buffer_ += '"';
+  }
+  void csi(std::size_t count, char command) {
+    buffer_ += "\033[";
+    buffer_ += std::to_string(count);
+    buffer_ += command;
+  }
+  // cells are only tracked per byte, so anything but printable ascii is
+  // always repainted as a whole line
+  static bool is_plain(const std::string &line) {
+    for (unsigned char c : line) {
+      if (c < 0x20 || c >= 0x7f) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /* Render Thread */
+  // The latest state of the retained block.
+  struct Snapshot {
+    std::vector<std::string> lines;
+    std::size_t column = 0;
+    uint64_t seq = 0;
+  };
+  // Output that has to be drawn in order: a block drawn once, or a newline
+  // after the retained block, carrying its final lines.
+  struct Op {
+    enum class Kind : uint8_t { OUT, NEWLINE };
+
+    Kind kind;
+    std::vector<std::string> lines;
+    std::size_t column;
+    uint64_t seq;
+  };
+  struct Renderer {
+    std::chrono::nanoseconds interval;
+    std::thread thread;
+    TripleBuffer<Snapshot> region;
+    std::atomic<uint32_t> size;
+    std::atomic<uint32_t> resizes;
+    std::mutex stats_mutex;
+
+    // guarded by mutex
+    std::mutex mutex;
+    std::condition_variable tick;
+    std::condition_variable synced;
+    std::vector<Op> ops;
+    bool stop = false;
+    uint64_t sync_to = 0;
+    uint64_t flushed = 0;
+
+    // the calling thread's; seq orders snapshots and ops
+    uint64_t seq = 0;
+    uint32_t depth = 0;
+    bool retain = false;
+    bool live = false;
+    bool dirty = false;
+    std::vector<std::string> last;
+    std::size_t column = 0;
+
+    // the render thread's
+    uint64_t drawn = 0;
+  };
+
+  void start_rendering(std::chrono::nanoseconds interval) {
+    render_ = std::make_unique<Renderer>();
+    render_->interval = interval;
+    render_->size.store(width_ << 16 | height_);
+    render_->resizes.store(seen_resizes_);
+    render_->thread = std::thread{[this] { render_loop(); }};
+  }
+  void stop_rendering() {
+    if (!render_) {
+      return;
+    }
+    {
+      std::lock_guard lock{render_->mutex};
+      render_->stop = true;
+    }
+    render_->tick.notify_one();
+    channel_->wake.notify();
+    render_->thread.join();
+    render_.reset();
+  }
+  std::unique_lock<std::mutex> lock_stats() const {
+    return render_ ? std::unique_lock{render_->stats_mutex}
+                   : std::unique_lock<std::mutex>{};
+  }
+  void publish_region() {
+    Renderer &render = *render_;
+    if (render.depth > 0) {
+      render.dirty = true;
+      return;
+    }
+    render.dirty = false;
+    Snapshot &snapshot = render.region.back();
+    snapshot.lines = render.last;
+    snapshot.column = render.column;
+    snapshot.seq = ++render.seq;
+    render.region.publish();
+    channel_->wake.notify();
+  }
+  void submit(Op::Kind kind, std::span<const std::string> lines,
+              std::size_t column) {
+    Renderer &render = *render_;
+    Op op{kind, {lines.begin(), lines.end()}, column, ++render.seq};
+    {
+      std::lock_guard lock{render.mutex};
+      render.ops.push_back(std::move(op));
+    }
+    channel_->wake.notify();
+  }
+  // The size as of the latest resize. The render thread only queries it when
+  // it draws, which it may not do for a while if nothing else changes.
+  uint32_t render_size() {
+    Renderer &render = *render_;
+    uint32_t resizes = resizes_.load(std::memory_order_relaxed);
+    if (render.resizes.exchange(resizes, std::memory_order_relaxed) !=
+        resizes) {
+      winsize w{};
+      if (ioctl(fd_, TIOCGWINSZ, &w) == 0 && w.ws_col > 0 && w.ws_row > 0) {
+        render.size.store(w.ws_col << 16 | w.ws_row, std::memory_order_relaxed);
+      }
+      // the terminal may have rewrapped the retained block
+      channel_->wake.notify();
+    }
+    return render.size.load(std::memory_order_relaxed);
+  }
+  // Commits a frame at most once per interval, or sooner when sync() asks for
+  // one, and sleeps while there is nothing new to draw.
+  void render_loop() {
+    Renderer &render = *render_;
+    std::vector<Op> ops;
+    auto next_frame = std::chrono::steady_clock::now();
+    while (true) {
+      bool stop;
+      {
+        // read before looking for work, so that a notify() in between is seen
+        uint32_t epoch = channel_->wake.epoch();
+        std::unique_lock lock{render.mutex};
+        auto urgent = [&] {
+          return render.stop || render.sync_to > render.flushed;
+        };
+        if (!urgent() && !has_work()) {
+          lock.unlock();
+          channel_->wake.wait(epoch);
+          continue;
+        }
+        render.tick.wait_until(lock, next_frame, urgent);
+        stop = render.stop;
+        ops.swap(render.ops);
+      }
+      next_frame = std::chrono::steady_clock::now() + render.interval;
+      render_frame(ops);
+      ops.clear();
+      {
+        std::lock_guard lock{render.mutex};
+        render.flushed = render.drawn;
+      }
+      render.synced.notify_all();
+      if (stop) {
+        break;
+      }
+    }
+  }
+  // Whether a frame would draw anything. Called with render_->mutex held.
+  bool has_work() const {
+    Renderer &render = *render_;
+    return !render.ops.empty() || render.region.pending() ||
+           resizes_.load(std::memory_order_relaxed) != seen_resizes_ ||
+           (!channel_->logs.empty() && draws_logs());
+  }
+  // Leaves the shared log lines to whichever writer draws next, waking a
+  // render thread that may print them.
+  void release_logs() {
+    const Writer *self = this;
+    if (channel_->drawing.compare_exchange_strong(self, nullptr)) {
+      channel_->wake.notify();
+    }
+  }
+  // Whether this writer prints the shared log lines: another one running a
+  // component prints them instead.
+  bool draws_logs() const {
+    const Writer *drawing = channel_->drawing.load();
+    return !drawing || drawing == this;
+  }
+  // Draws the queued ops, and the latest snapshot in its place among them.
+  void render_frame(std::vector<Op> &ops) {
+    Renderer &render = *render_;
+    update_size();
+    render.size.store(width_ << 16 | height_, std::memory_order_relaxed);
+    const Snapshot *snapshot =
+        render.region.acquire() ? &render.region.front() : nullptr;
+    frame_depth_++;
+    for (const Op &op : ops) {
+      if (snapshot && snapshot->seq < op.seq) {
+        draw_region(snapshot->lines, snapshot->column, snapshot->seq);
+        snapshot = nullptr;
+      }
+      if (!op.lines.empty() || op.kind == Op::Kind::OUT) {
+        if (op.kind == Op::Kind::NEWLINE) {
+          draw_region(op.lines, op.column, op.seq);
+        } else {
+          paint(op.lines);
+        }
+      }
+      if (op.kind == Op::Kind::NEWLINE) {
+        step_past();
+      }
+      render.drawn = op.seq;
+    }
+    if (snapshot) {
+      draw_region(snapshot->lines, snapshot->column, snapshot->seq);
+    }
+    if (draws_logs()) {
+      draw_logs();
+    }
+    frame_depth_--;
+    commit();
+  }
+  void draw_region(std::span<const std::string> lines, std::size_t column,
+                   uint64_t seq) {
+    // a snapshot older than ordered output already drawn is out of date
+    if (seq < render_->drawn) {
+      return;
+    }
+    render_->drawn = seq;
+    reset_cursor_ = true;
+    paint(lines);
+    if (column > 0) {
+      csi(column, 'G');
+    }
+  }
+
+  void flush() {
+    if (frame_depth_ == 0) {
+      commit();
+    }
+  }
+  void commit() {
+    if (buffer_.empty()) {
+      return;
+    }
+    // anything still sitting in std::cout must land before this frame
+    std::cout.flush();
+    const char *data = buffer_.data();
+    std::size_t remaining = buffer_.size();
+    WriterStats frame;
+    while (remaining > 0) {
+      ssize_t written = ::write(fd_, data, remaining);
+      frame.syscalls++;
+      if (written < 0) {
+        if (errno == EINTR || errno == EAGAIN) {
+          continue;
+        }
+        break;
+      }
+      data += written;
+      remaining -= written;
+      frame.bytes += written;
+    }
+    frame.frames = 1;
+    buffer_.clear();
+    std::unique_lock lock = lock_stats();
+    frame_stats_ = frame;
+    total_stats_.bytes += frame.bytes;
+    total_stats_.syscalls += frame.syscalls;
+    total_stats_.frames++;
+  }
 
 private:
+  static inline std::atomic<uint32_t> resizes_ = 0;
+  static inline void (*previous_handler_)(int) = SIG_DFL;
+
+  int fd_;
   unsigned short width_;
+  unsigned short height_;
+  uint32_t seen_resizes_ = 0;
+  bool stale_ = false;
+  bool structured_ = false;
+  bool headless_ = false;
+  double progress_step_ = 0.05;
+  std::chrono::nanoseconds progress_interval_ = std::chrono::seconds{1};
   bool reset_cursor_ = false;
+  uint32_t frame_depth_ = 0;
+  bool retained_ = false;
+  std::vector<std::string> screen_;
+  std::string buffer_;
+  WriterStats frame_stats_;
+  WriterStats total_stats_;
+  Tracer *tracer_ = nullptr;
+  Session *session_ = nullptr;
+  // shared with logging threads, so it stays put if the writer is moved
+  struct Channel {
+    LogQueue logs;
+    Wake wake;
+    // The writer running a component, so that an idle render thread of another
+    // writer sharing the channel does not print its lines.
+    std::atomic<const Writer *> drawing = nullptr;
+  };
+  std::shared_ptr<Channel> channel_ = std::make_shared<Channel>();
+  std::unique_ptr<Renderer> render_;
 };
 
 } // namespace quikcli
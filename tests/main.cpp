@@ -0,0 +1,41 @@
+#include "quikcli/quikcli.h"
+#include "test.h"
+#include <exception>
+#include <iostream>
+#include <string>
+
+int main(int argc, char *argv[]) {
+  std::string filter;
+  quikcli::QuikCli cli{"quikcli_tests", QUIKCLI_VERSION};
+  cli.add_flag("filter", "only run tests whose name contains this.", filter)
+      .set_alias('f');
+  if (quikcli::ParseResult<> result = cli.try_parse_flags(argc, argv);
+      !result) {
+    std::cerr << result.error().exception().what() << std::endl;
+    return 1;
+  }
+  if (!cli.is_active()) {
+    return 0;
+  }
+
+  int failed = 0;
+  int run = 0;
+  for (const test::Test &test : test::registry()) {
+    if (test.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    test::failures() = 0;
+    try {
+      test.body();
+    } catch (const std::exception &exception) {
+      test::fail(__FILE__, __LINE__,
+                 std::string{"uncaught exception: "} + exception.what());
+    }
+    run++;
+    failed += test::failures() > 0;
+    std::cout << (test::failures() > 0 ? "FAIL " : "ok   ") << test.name
+              << std::endl;
+  }
+  std::cout << run - failed << "/" << run << " passed" << std::endl;
+  return failed > 0 || run == 0;
+}
@@ -0,0 +1,289 @@
+#include "quikcli/quikcli.h"
+#include "test.h"
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using quikcli::ParseErrorCode;
+
+// Records the parameters each flag was given.
+struct Seen {
+  std::vector<std::string> all;
+  std::vector<std::string> out;
+  std::vector<std::string> name;
+  bool verbose = false;
+  bool quiet = false;
+};
+
+void add_flags(quikcli::QuikCli &cli, Seen &seen) {
+  cli.add_flag("all", "every item.",
+               [&seen](quikcli::flag_params_t params) {
+                 seen.all.assign(params.begin(), params.end());
+               })
+      .set_alias('a')
+      .set_param_count(0);
+  cli.add_flag("out", "file to write to.",
+               [&seen](quikcli::flag_params_t params) {
+                 seen.out.assign(params.begin(), params.end());
+               })
+      .set_alias('o')
+      .set_param_count(1);
+  cli.add_flag("name", "names to greet.",
+               [&seen](quikcli::flag_params_t params) {
+                 seen.name.assign(params.begin(), params.end());
+               })
+      .set_alias('n');
+  cli.add_flag("verbose", "print more output.",
+               [&seen](quikcli::flag_params_t) { seen.verbose = true; })
+      .set_alias('v')
+      .set_param_count(0);
+  cli.add_flag("quiet", "print less output.",
+               [&seen](quikcli::flag_params_t) { seen.quiet = true; })
+      .set_alias('q')
+      .set_param_count(0);
+}
+
+void check_error(const quikcli::ParseResult<> &result, ParseErrorCode code,
+                 int position, std::string_view arg) {
+  CHECK(!result);
+  if (result) {
+    return;
+  }
+  CHECK_EQ(result.error().code, code);
+  CHECK_EQ(result.error().position, position);
+  CHECK_EQ(result.error().arg, arg);
+}
+
+/* Error Codes */
+void error_codes() {
+  // the values are part of the interface
+  CHECK_EQ(static_cast<int>(ParseErrorCode::UNKNOWN_FLAG), 0);
+  CHECK_EQ(static_cast<int>(ParseErrorCode::UNEXPECTED_ARGUMENT), 1);
+  CHECK_EQ(static_cast<int>(ParseErrorCode::REPEATED_FLAG), 2);
+  CHECK_EQ(static_cast<int>(ParseErrorCode::WRONG_PARAM_COUNT), 3);
+  CHECK_EQ(static_cast<int>(ParseErrorCode::INVALID_PARAM), 4);
+  CHECK_EQ(static_cast<int>(ParseErrorCode::UNKNOWN_COMMAND), 5);
+  CHECK_EQ(static_cast<int>(ParseErrorCode::RESPONSE_FILE_UNREADABLE), 6);
+  CHECK_EQ(static_cast<int>(ParseErrorCode::RESPONSE_FILE_TOO_DEEP), 7);
+  CHECK_EQ(static_cast<int>(ParseErrorCode::UNTERMINATED_QUOTE), 8);
+}
+
+void unknown_flag() {
+  Seen seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", "-v", "--missing"}};
+  check_error(cli.try_parse_flags(args.argc(), args.argv()),
+              ParseErrorCode::UNKNOWN_FLAG, 2, "--missing");
+}
+
+void unexpected_argument() {
+  Seen seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", "stray", "-v"}};
+  check_error(cli.try_parse_flags(args.argc(), args.argv()),
+              ParseErrorCode::UNEXPECTED_ARGUMENT, 1, "stray");
+}
+
+void repeated_flag() {
+  Seen seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", "--verbose", "-q", "-v"}};
+  check_error(cli.try_parse_flags(args.argc(), args.argv()),
+              ParseErrorCode::REPEATED_FLAG, 3, "-v");
+}
+
+void wrong_param_count() {
+  Seen seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", "-v", "--out"}};
+  quikcli::ParseResult<> result = cli.try_parse_flags(args.argc(), args.argv());
+  check_error(result, ParseErrorCode::WRONG_PARAM_COUNT, 2, "--out");
+  if (!result) {
+    CHECK_EQ(result.error().expected, 1u);
+    CHECK_EQ(result.error().received, 0u);
+  }
+}
+
+void invalid_param() {
+  int count = 0;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  cli.add_flag("count", "how many.", count);
+  test::Argv args{{"prog", "--count", "many"}};
+  quikcli::ParseResult<> result = cli.try_parse_flags(args.argc(), args.argv());
+  CHECK(!result);
+  if (!result) {
+    CHECK_EQ(result.error().code, ParseErrorCode::INVALID_PARAM);
+    CHECK_EQ(result.error().type(), quikcli::ExceptionType::PARSER);
+  }
+}
+
+void unknown_command() {
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  cli.add_flag("verbose", "print more output.").set_alias('v');
+  cli.add_subcommand("ask", "ask a question.", [](quikcli::QuikCli &) {});
+  test::Argv args{{"prog", "-v", "tell"}};
+  check_error(cli.try_parse_flags(args.argc(), args.argv()),
+              ParseErrorCode::UNKNOWN_COMMAND, 2, "tell");
+}
+
+/* Flag Forms */
+void chained_aliases() {
+  Seen seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", "-vqo", "file.txt"}};
+  CHECK(cli.try_parse_flags(args.argc(), args.argv()));
+  CHECK(seen.verbose);
+  CHECK(seen.quiet);
+  CHECK_EQ(seen.out, std::vector<std::string>{"file.txt"});
+}
+
+void chained_alias_needs_no_params() {
+  Seen seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  // only the last alias of a chain takes the following parameters
+  test::Argv args{{"prog", "-ov", "file.txt"}};
+  quikcli::ParseResult<> result = cli.try_parse_flags(args.argc(), args.argv());
+  CHECK(!result);
+  if (!result) {
+    CHECK_EQ(result.error().code, ParseErrorCode::WRONG_PARAM_COUNT);
+    CHECK_EQ(result.error().position, 1);
+  }
+}
+
+void chained_unknown_alias() {
+  Seen seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", "-q", "-vz"}};
+  quikcli::ParseResult<> result = cli.try_parse_flags(args.argc(), args.argv());
+  CHECK(!result);
+  if (!result) {
+    CHECK_EQ(result.error().code, ParseErrorCode::UNKNOWN_FLAG);
+    CHECK_EQ(result.error().position, 2);
+  }
+}
+
+void attached_value() {
+  Seen seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", "--out=a=b", "--name=x", "y"}};
+  CHECK(cli.try_parse_flags(args.argc(), args.argv()));
+  CHECK_EQ(seen.out, std::vector<std::string>{"a=b"});
+  CHECK_EQ(seen.name, (std::vector<std::string>{"x", "y"}));
+}
+
+void attached_value_counts() {
+  Seen seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", "-v", "--all=yes"}};
+  quikcli::ParseResult<> result = cli.try_parse_flags(args.argc(), args.argv());
+  check_error(result, ParseErrorCode::WRONG_PARAM_COUNT, 2, "--all=yes");
+  if (!result) {
+    CHECK_EQ(result.error().expected, 0u);
+    CHECK_EQ(result.error().received, 1u);
+  }
+}
+
+/* Subcommands */
+void add_commands(quikcli::QuikCli &cli) {
+  cli.add_flag("verbose", "print more output.").set_alias('v');
+  cli.add_subcommand("ask", "ask a question.", [](quikcli::QuikCli &ask) {
+    ask.add_flag("all", "every item.").set_alias('a');
+    ask.add_subcommand("again", "ask again.", [](quikcli::QuikCli &again) {
+      again.add_flag("loud", "ask loudly.");
+    });
+  });
+}
+
+// Errors inside a subcommand report positions in the whole command line,
+// whether parsed or only validated.
+void subcommand_positions() {
+  for (bool validate : {false, true}) {
+    // flags stay set after a parse, so each line gets its own QuikCli; the
+    // error views argv, so it is checked while args lives
+    auto check = [validate](std::vector<std::string> line,
+                            std::optional<ParseErrorCode> code = {},
+                            int position = 0, std::string_view arg = {}) {
+      quikcli::QuikCli cli{"prog", "0.0.1"};
+      add_commands(cli);
+      test::Argv args{std::move(line)};
+      quikcli::ParseResult<> result =
+          validate ? cli.validate_flags(args.argc(), args.argv())
+                   : cli.try_parse_flags(args.argc(), args.argv());
+      if (code) {
+        check_error(result, *code, position, arg);
+      } else {
+        CHECK(result);
+      }
+    };
+    check({"prog", "-v", "ask", "-a", "--nope"}, ParseErrorCode::UNKNOWN_FLAG,
+          4, "--nope");
+    check({"prog", "-v", "ask", "-a", "again", "--loud", "-x"},
+          ParseErrorCode::UNKNOWN_FLAG, 6, "-x");
+    check({"prog", "ask", "again", "--loud", "--loud"},
+          ParseErrorCode::REPEATED_FLAG, 4, "--loud");
+    check({"prog", "ask", "-a", "tell"}, ParseErrorCode::UNKNOWN_COMMAND, 3,
+          "tell");
+    check({"prog", "-v", "ask", "again", "--loud"});
+  }
+}
+
+// A validating QuikCli keeps no flags set, so it checks line after line.
+void validate_repeatedly() {
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_commands(cli);
+  for (int i = 0; i < 2; i++) {
+    test::Argv args{{"prog", "-v", "ask", "-a", "again", "--loud"}};
+    CHECK(cli.validate_flags(args.argc(), args.argv()));
+    test::Argv wrong{{"prog", "-v", "ask", "again", "--quiet"}};
+    check_error(cli.validate_flags(wrong.argc(), wrong.argv()),
+                ParseErrorCode::UNKNOWN_FLAG, 4, "--quiet");
+  }
+}
+
+void subcommand_selected() {
+  bool all = false;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  cli.add_flag("verbose", "print more output.").set_alias('v');
+  cli.add_subcommand("ask", "ask a question.", [&all](quikcli::QuikCli &ask) {
+    ask.add_flag("all", "every item.",
+                 [&all](quikcli::flag_params_t) { all = true; })
+        .set_param_count(0);
+  });
+  test::Argv args{{"prog", "-v", "ask", "--all"}};
+  CHECK(cli.try_parse_flags(args.argc(), args.argv()));
+  CHECK(cli.subcommand() != nullptr);
+  CHECK(all);
+}
+
+test::Register codes{"parser/error_codes", error_codes};
+test::Register unknown{"parser/unknown_flag", unknown_flag};
+test::Register unexpected{"parser/unexpected_argument", unexpected_argument};
+test::Register repeated{"parser/repeated_flag", repeated_flag};
+test::Register count{"parser/wrong_param_count", wrong_param_count};
+test::Register invalid{"parser/invalid_param", invalid_param};
+test::Register command{"parser/unknown_command", unknown_command};
+test::Register chained{"parser/chained_aliases", chained_aliases};
+test::Register chained_params{"parser/chained_alias_needs_no_params",
+                              chained_alias_needs_no_params};
+test::Register chained_unknown{"parser/chained_unknown_alias",
+                               chained_unknown_alias};
+test::Register attached{"parser/attached_value", attached_value};
+test::Register attached_counts{"parser/attached_value_counts",
+                               attached_value_counts};
+test::Register positions{"parser/subcommand_positions", subcommand_positions};
+test::Register validate{"parser/validate_repeatedly", validate_repeatedly};
+test::Register selected{"parser/subcommand_selected", subcommand_selected};
+
+} // namespace
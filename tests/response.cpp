@@ -0,0 +1,173 @@
+#include "quikcli/quikcli.h"
+#include "test.h"
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+using quikcli::ParseErrorCode;
+
+// A response file in the temporary directory, removed once out of scope.
+class TempFile {
+public:
+  TempFile(const std::string &name, const std::string &contents)
+      : path_{(std::filesystem::temp_directory_path() /
+               ("quikcli_tests_" + std::to_string(getpid()) + "_" + name))
+                  .string()} {
+    std::ofstream{path_} << contents;
+  }
+  TempFile(const TempFile &) = delete;
+  TempFile &operator=(const TempFile &) = delete;
+  ~TempFile() { std::filesystem::remove(path_); }
+
+  const std::string &path() const { return path_; }
+  std::string arg() const { return "@" + path_; }
+
+private:
+  std::string path_;
+};
+
+struct Names {
+  std::vector<std::string> names;
+  bool verbose = false;
+};
+
+void add_flags(quikcli::QuikCli &cli, Names &seen) {
+  cli.add_flag("name", "names to greet.",
+               [&seen](quikcli::flag_params_t params) {
+                 seen.names.assign(params.begin(), params.end());
+               })
+      .set_alias('n');
+  cli.add_flag("verbose", "print more output.",
+               [&seen](quikcli::flag_params_t) { seen.verbose = true; })
+      .set_alias('v')
+      .set_param_count(0);
+}
+
+void quoting() {
+  TempFile file{"quoting", "--name plain 'single \"quoted\" \\n'"
+                          " \"double \\\"q\\\"\"\n  with\\ space ''\n-v\n"};
+  Names seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", file.arg()}};
+  CHECK(cli.try_parse_flags(args.argc(), args.argv()));
+  CHECK_EQ(seen.names,
+           (std::vector<std::string>{"plain", "single \"quoted\" \\n",
+                                     "double \"q\"", "with space", ""}));
+  CHECK(seen.verbose);
+}
+
+void mixed_with_argv() {
+  TempFile file{"mixed", "a b"};
+  Names seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", "--name", "first", file.arg(), "last", "-v"}};
+  CHECK(cli.try_parse_flags(args.argc(), args.argv()));
+  CHECK_EQ(seen.names,
+           (std::vector<std::string>{"first", "a", "b", "last"}));
+  CHECK(seen.verbose);
+}
+
+// Errors in a response file report the position of the @path that named it.
+void error_position() {
+  TempFile file{"error", "-v --missing"};
+  Names seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", "--name", "x", file.arg()}};
+  quikcli::ParseResult<> result = cli.try_parse_flags(args.argc(), args.argv());
+  CHECK(!result);
+  if (!result) {
+    CHECK_EQ(result.error().code, ParseErrorCode::UNKNOWN_FLAG);
+    CHECK_EQ(result.error().position, 3);
+    CHECK_EQ(result.error().arg, "--missing");
+  }
+}
+
+void unterminated_quote() {
+  TempFile file{"unterminated", "--name 'open ended"};
+  Names seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", "-v", file.arg()}};
+  quikcli::ParseResult<> result = cli.try_parse_flags(args.argc(), args.argv());
+  CHECK(!result);
+  if (!result) {
+    CHECK_EQ(result.error().code, ParseErrorCode::UNTERMINATED_QUOTE);
+    CHECK_EQ(result.error().position, 2);
+    CHECK_EQ(result.error().arg, file.path());
+    CHECK_EQ(result.error().type(), quikcli::ExceptionType::PARSER);
+  }
+}
+
+void too_deep() {
+  // names itself, so it nests until the depth limit
+  TempFile file{"deep", ""};
+  std::ofstream{file.path()} << file.arg();
+  Names seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", "--name", "x", file.arg()}};
+  quikcli::ParseResult<> result = cli.try_parse_flags(args.argc(), args.argv());
+  CHECK(!result);
+  if (!result) {
+    CHECK_EQ(result.error().code, ParseErrorCode::RESPONSE_FILE_TOO_DEEP);
+    CHECK_EQ(result.error().position, 3);
+    CHECK_EQ(result.error().arg, file.path());
+    CHECK_EQ(result.error().type(), quikcli::ExceptionType::PARSER);
+  }
+}
+
+void max_depth() {
+  // a chain exactly ResponseFileDefaults::max_depth files long is read
+  std::deque<TempFile> files;
+  files.emplace_back("depth_0", "-v");
+  for (uint32_t i = 1; i < quikcli::ResponseFileDefaults::max_depth; i++) {
+    files.emplace_back("depth_" + std::to_string(i), files.back().arg());
+  }
+  Names seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", files.back().arg()}};
+  CHECK(cli.try_parse_flags(args.argc(), args.argv()));
+  CHECK(seen.verbose);
+}
+
+void unreadable() {
+  std::string path = (std::filesystem::temp_directory_path() /
+                      "quikcli_tests_missing_response_file")
+                         .string();
+  Names seen;
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  add_flags(cli, seen);
+  test::Argv args{{"prog", "-v", "@" + path}};
+  for (bool validate : {false, true}) {
+    quikcli::ParseResult<> result =
+        validate ? cli.validate_flags(args.argc(), args.argv())
+                 : cli.try_parse_flags(args.argc(), args.argv());
+    CHECK(!result);
+    if (!result) {
+      CHECK_EQ(result.error().code, ParseErrorCode::RESPONSE_FILE_UNREADABLE);
+      CHECK_EQ(result.error().position, 2);
+      CHECK_EQ(result.error().arg, path);
+      CHECK_EQ(result.error().type(), quikcli::ExceptionType::IO);
+    }
+  }
+}
+
+test::Register quotes{"response/quoting", quoting};
+test::Register mixed{"response/mixed_with_argv", mixed_with_argv};
+test::Register position{"response/error_position", error_position};
+test::Register unterminated{"response/unterminated_quote", unterminated_quote};
+test::Register deep{"response/too_deep", too_deep};
+test::Register depth{"response/max_depth", max_depth};
+test::Register missing{"response/unreadable", unreadable};
+
+} // namespace
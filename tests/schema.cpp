@@ -0,0 +1,178 @@
+#include "quikcli/quikcli.h"
+#include "quikcli/schema.h"
+#include "test.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using quikcli::ParseErrorCode;
+
+constexpr quikcli::FlagSchema schema{{
+    {"all", "every item.", 'a'},
+    {"out", "file to write to.", 'o', 1},
+    {"pair", "two values.", 'p', 2},
+    {"name", "names to greet.", 'n', quikcli::FlagParamSize::VARIADIC},
+    {"verbose", "print more output.", 'v'},
+}};
+
+void lookup() {
+  for (std::size_t i = 0; i < schema.size(); i++) {
+    CHECK_EQ(schema.find(schema[i].name).value_or(schema.size()), i);
+    CHECK_EQ(schema.find(schema[i].alias).value_or(schema.size()), i);
+  }
+  CHECK(!schema.find("missing").has_value());
+  CHECK(!schema.find('z').has_value());
+  CHECK(!schema.find(std::string_view{}).has_value());
+}
+
+void params() {
+  test::Argv args{{"prog", "-vo", "file", "--pair=1", "2", "-n"}};
+  quikcli::ParseResult<quikcli::SchemaArgs<schema.size()>> result =
+      schema.try_parse(args.argc(), args.argv());
+  CHECK(result);
+  if (!result) {
+    return;
+  }
+  CHECK(result->is_set("verbose"));
+  CHECK(!result->is_set("all"));
+  CHECK(result->is_set("name"));
+  CHECK(result->params("name").empty());
+  CHECK_EQ(result->params("out").size(), 1u);
+  CHECK_EQ(std::string_view{result->params("out")[0]}, "file");
+  std::vector<std::string> pair;
+  for (const char *param : result->params("pair")) {
+    pair.emplace_back(param);
+  }
+  CHECK_EQ(pair, (std::vector<std::string>{"1", "2"}));
+  CHECK(result->params("missing").empty());
+}
+
+// The same command line parsed against the schema and against QuikCli flags
+// registered from it.
+struct Outcome {
+  bool ok = false;
+  ParseErrorCode code{};
+  int position = 0;
+  std::string arg;
+  uint32_t expected = 0;
+  uint32_t received = 0;
+  std::vector<std::vector<std::string>> params;
+};
+
+Outcome outcome(const quikcli::ParseResult<> &result) {
+  Outcome outcome{result.has_value()};
+  if (!result) {
+    const quikcli::ParseError &error = result.error();
+    outcome.code = error.code;
+    outcome.position = error.position;
+    outcome.arg = error.arg;
+    outcome.expected = error.expected;
+    outcome.received = error.received;
+  }
+  return outcome;
+}
+
+Outcome parse_schema(std::vector<std::string> line) {
+  test::Argv args{std::move(line)};
+  quikcli::ParseResult<quikcli::SchemaArgs<schema.size()>> result =
+      schema.try_parse(args.argc(), args.argv());
+  Outcome parsed =
+      outcome(result ? quikcli::ParseResult<>{} : result.error());
+  if (result) {
+    for (std::size_t i = 0; i < schema.size(); i++) {
+      std::vector<std::string> &params = parsed.params.emplace_back();
+      if (result->is_set(i)) {
+        params.assign(result->params(i).begin(), result->params(i).end());
+        // set flags are told apart from unset ones without parameters
+        params.insert(params.begin(), "set");
+      }
+    }
+  }
+  return parsed;
+}
+
+Outcome parse_runtime(std::vector<std::string> line) {
+  test::Argv args{std::move(line)};
+  std::vector<std::vector<std::string>> params(schema.size());
+  quikcli::QuikCli cli{"prog", "0.0.1"};
+  for (std::size_t i = 0; i < schema.size(); i++) {
+    const quikcli::FlagSpec &spec = schema[i];
+    cli.add_flag(spec.name, spec.description,
+                 [&params, i](quikcli::flag_params_t set) {
+                   params[i].assign(set.begin(), set.end());
+                   params[i].insert(params[i].begin(), "set");
+                 })
+        .set_alias(spec.alias)
+        .set_param_count(spec.param_count);
+  }
+  Outcome parsed = outcome(cli.try_parse_flags(args.argc(), args.argv()));
+  if (parsed.ok) {
+    parsed.params = std::move(params);
+  }
+  return parsed;
+}
+
+void agreement() {
+  const std::vector<std::vector<std::string>> lines = {
+      {"prog"},
+      {"prog", "-a"},
+      {"prog", "--all", "--verbose"},
+      {"prog", "-av"},
+      {"prog", "-vao", "file"},
+      {"prog", "-o", "file", "-p", "1", "2"},
+      {"prog", "--out=file"},
+      {"prog", "--out=a=b"},
+      {"prog", "--out="},
+      {"prog", "--pair=1", "2"},
+      {"prog", "--name"},
+      {"prog", "--name", "x", "y", "z", "-v"},
+      {"prog", "-n", "-", "x"},
+      {"prog", "--name=x", "y"},
+      // UNKNOWN_FLAG
+      {"prog", "--missing"},
+      {"prog", "-a", "-z"},
+      {"prog", "-az"},
+      {"prog", "--"},
+      {"prog", "--=x"},
+      // UNEXPECTED_ARGUMENT
+      {"prog", "stray"},
+      {"prog", "-"},
+      // REPEATED_FLAG
+      {"prog", "-a", "--all"},
+      {"prog", "-aa"},
+      {"prog", "--out=x", "-o", "y"},
+      // WRONG_PARAM_COUNT
+      {"prog", "-o"},
+      {"prog", "-o", "x", "y"},
+      {"prog", "-ov", "x"},
+      {"prog", "-a", "x"},
+      {"prog", "--all=x"},
+      {"prog", "-p", "1"},
+      {"prog", "--pair=1"},
+      {"prog", "-v", "-p", "1", "2", "3"},
+  };
+  for (const std::vector<std::string> &line : lines) {
+    Outcome parsed = parse_schema(line);
+    Outcome expected = parse_runtime(line);
+    std::string command;
+    for (const std::string &arg : line) {
+      command += " " + arg;
+    }
+    if (parsed.ok != expected.ok || parsed.code != expected.code ||
+        parsed.position != expected.position || parsed.arg != expected.arg ||
+        parsed.expected != expected.expected ||
+        parsed.received != expected.received ||
+        parsed.params != expected.params) {
+      test::fail(__FILE__, __LINE__,
+                 "schema and runtime disagree on" + command);
+    }
+  }
+}
+
+test::Register find{"schema/lookup", lookup};
+test::Register values{"schema/params", params};
+test::Register agree{"schema/agreement", agreement};
+
+} // namespace
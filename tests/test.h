@@ -0,0 +1,108 @@
+#ifndef QC_TEST_H_
+#define QC_TEST_H_
+
+#include <functional>
+#include <iostream>
+#include <ranges>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace test {
+
+using body_t = std::function<void()>;
+
+struct Test {
+  std::string name;
+  body_t body;
+};
+
+inline std::vector<Test> &registry() {
+  static std::vector<Test> tests;
+  return tests;
+}
+
+struct Register {
+  Register(std::string name, body_t body) {
+    registry().push_back({std::move(name), std::move(body)});
+  }
+};
+
+// Failed checks in the test being run. A check that fails reports itself and
+// lets the test go on, so one run shows every broken expectation.
+inline int &failures() {
+  static int count = 0;
+  return count;
+}
+
+inline void fail(const char *file, int line, const std::string &message) {
+  std::cerr << file << ':' << line << ": " << message << std::endl;
+  failures()++;
+}
+
+// Enums such as ParseErrorCode are shown by their value, and containers of
+// strings as {a, b}.
+template <class T> void show(std::ostream &out, const T &value) {
+  if constexpr (std::is_enum_v<T>) {
+    out << static_cast<long long>(value);
+  } else if constexpr (std::ranges::range<T> &&
+                       !std::is_convertible_v<T, std::string_view>) {
+    out << '{';
+    const char *separator = "";
+    for (const auto &element : value) {
+      out << separator << '"' << element << '"';
+      separator = ", ";
+    }
+    out << '}';
+  } else {
+    out << value;
+  }
+}
+
+template <class A, class B>
+void check_eq(const A &actual, const B &expected, const char *expression,
+              const char *file, int line) {
+  if (actual == expected) {
+    return;
+  }
+  std::ostringstream message;
+  message << expression << ": got ";
+  show(message, actual);
+  message << ", expected ";
+  show(message, expected);
+  fail(file, line, message.str());
+}
+
+// argv for a command line given as strings, which must outlive it.
+class Argv {
+public:
+  Argv(std::vector<std::string> args) : args_{std::move(args)} {
+    for (std::string &arg : args_) {
+      argv_.push_back(arg.data());
+    }
+    argv_.push_back(nullptr);
+  }
+
+  int argc() const { return args_.size(); }
+  char **argv() { return argv_.data(); }
+
+private:
+  std::vector<std::string> args_;
+  std::vector<char *> argv_;
+};
+
+} // namespace test
+
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      test::fail(__FILE__, __LINE__, "CHECK(" #condition ") failed");          \
+    }                                                                          \
+  } while (false)
+#define CHECK_EQ(actual, expected)                                             \
+  test::check_eq((actual), (expected), #actual, __FILE__, __LINE__)
+
+#endif // QC_TEST_H_